@@ -0,0 +1,144 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #define NOVA_HAS_MMAP 1
+#else
+    #define NOVA_HAS_MMAP 0
+#endif
+
+#include "util.hpp"
+
+namespace nova {
+
+// size of the chunks a PagePool requests from the OS, this should match the huge page size of the target.
+#ifndef NOVA_HUGE_PAGE_SIZE
+    #define NOVA_HUGE_PAGE_SIZE (std::size_t{2} << 20)
+#endif
+
+namespace detail {
+
+struct mapped_chunk {
+    void* data;
+    std::size_t size;
+    bool mapped;
+};
+
+// maps a NOVA_HUGE_PAGE_SIZE aligned chunk of memory.
+// explicit huge pages are tried first, then a regular mapping advised for transparent huge pages.
+inline mapped_chunk map_chunk(std::size_t const size) {
+#if NOVA_HAS_MMAP
+    #if defined(MAP_HUGETLB)
+    if (void* const p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0); p != MAP_FAILED)
+        return {p, size, true};
+    #endif
+    // over-allocate so the chunk can be aligned to a huge page boundary, then trim the excess.
+    std::size_t const padded = size + NOVA_HUGE_PAGE_SIZE;
+    if (void* const p = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); p != MAP_FAILED) {
+        auto const base = reinterpret_cast<std::uintptr_t>(p);
+        auto const aligned = (base + NOVA_HUGE_PAGE_SIZE - 1) & ~(std::uintptr_t{NOVA_HUGE_PAGE_SIZE} - 1);
+        if (auto const head = aligned - base; head > 0)
+            ::munmap(p, head);
+        if (auto const tail = padded - (aligned - base) - size; tail > 0)
+            ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+    #if defined(MADV_HUGEPAGE)
+        ::madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+    #endif
+        return {reinterpret_cast<void*>(aligned), size, true};
+    }
+#endif
+    return {::operator new(size, std::align_val_t{NOVA_HUGE_PAGE_SIZE}), size, false};
+}
+
+inline void unmap_chunk(mapped_chunk const& chunk) noexcept {
+#if NOVA_HAS_MMAP
+    if (chunk.mapped) {
+        ::munmap(chunk.data, chunk.size);
+        return;
+    }
+#endif
+    ::operator delete(chunk.data, std::align_val_t{NOVA_HUGE_PAGE_SIZE});
+}
+
+} // namespace detail
+
+// Hands out fixed-size, page-size aligned blocks carved from huge page backed chunks.
+// Pages are recycled through a free list and only returned to the OS when the pool is destroyed.
+class PagePool {
+    std::size_t page_size_;
+    std::mutex mutex_;
+    std::vector<void*> free_;
+    std::vector<detail::mapped_chunk> chunks_;
+
+    void grow(std::size_t const num_pages) {
+        auto const pages_per_chunk = NOVA_HUGE_PAGE_SIZE / page_size_;
+        auto const num_chunks = (num_pages + pages_per_chunk - 1) / pages_per_chunk;
+        auto const size = num_chunks * NOVA_HUGE_PAGE_SIZE;
+        auto const chunk = detail::map_chunk(size);
+        chunks_.push_back(chunk);
+        free_.reserve(free_.size() + size / page_size_);
+        // push in reverse so pages are handed out in address order.
+        for (std::size_t offset = size; offset > 0; offset -= page_size_)
+            free_.push_back(static_cast<std::byte*>(chunk.data) + offset - page_size_);
+    }
+
+public:
+    explicit PagePool(std::size_t const page_size) noexcept
+        : page_size_(page_size)
+    {
+        NOVA_ASSERT(std::has_single_bit(page_size) && page_size <= NOVA_HUGE_PAGE_SIZE);
+    }
+
+    PagePool(PagePool const&) = delete;
+    PagePool& operator=(PagePool const&) = delete;
+
+    ~PagePool() {
+        for (auto const& chunk : chunks_)
+            detail::unmap_chunk(chunk);
+    }
+
+    // a process wide pool per page size, intentionally leaked so storages outliving static destruction stay valid.
+    static PagePool& shared(std::size_t const page_size) {
+        static std::mutex mutex;
+        static std::vector<PagePool*> pools;
+        std::lock_guard lock{mutex};
+        for (auto* const pool : pools) {
+            if (pool->pageSize() == page_size)
+                return *pool;
+        }
+        return *pools.emplace_back(new PagePool(page_size));
+    }
+
+    std::size_t pageSize() const noexcept {
+        return page_size_;
+    }
+
+    void reserve(std::size_t const num_pages) {
+        std::lock_guard lock{mutex_};
+        if (free_.size() < num_pages)
+            grow(num_pages - free_.size());
+    }
+
+    [[nodiscard]] void* allocate() {
+        std::lock_guard lock{mutex_};
+        if (free_.empty())
+            grow(1);
+        auto* const page = free_.back();
+        free_.pop_back();
+        return page;
+    }
+
+    void deallocate(void* const page) {
+        std::lock_guard lock{mutex_};
+        free_.push_back(page);
+    }
+};
+
+} // namespace nova
\ No newline at end of file
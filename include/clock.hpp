@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <thread>
+
+#include "task.hpp"
+#include "util.hpp"
+#include "world.hpp"
+
+namespace nova {
+
+// Where a simulation loop gets its time from. `now` is the time since the clock started.
+template<class C>
+concept Clock = requires(C& c, Time const t) {
+    { c.now() } -> std::same_as<Time>;
+    c.sleepUntil(t);
+};
+
+// wall-clock time, for servers running in real time.
+class SteadyClock {
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+public:
+    Time now() const {
+        return std::chrono::duration_cast<Time>(std::chrono::steady_clock::now() - start_);
+    }
+
+    void sleepUntil(Time const t) const {
+        std::this_thread::sleep_until(start_ + t);
+    }
+};
+
+// time that only moves when told to, sleeping jumps straight to the wake-up time. Runs a simulation as fast as it can.
+class ManualClock {
+    Time now_{0};
+
+public:
+    Time now() const noexcept {
+        return now_;
+    }
+
+    void sleepUntil(Time const t) noexcept {
+        now_ = std::max(now_, t);
+    }
+
+    void advance(Time const dt) noexcept {
+        now_ += dt;
+    }
+};
+
+// Updates `world` every `period` of `clock` time until `stop()` returns true. Ticks missed because updates ran
+// late are caught up, at most `max_catch_up` in a row; past that they are dropped so a stalled loop doesn't spiral.
+// Ticks are paced in nanoseconds, so a period that isn't a whole number of milliseconds, such as 60 Hz, doesn't
+// drift. Updates simulate whole milliseconds, carrying the remainder to the next one, so the time they simulate
+// adds up to the periods run. The period must be at least a millisecond.
+template<Clock C, class Stop>
+void runFixed(World& world, C& clock, std::chrono::nanoseconds const period, Stop&& stop, std::size_t const max_catch_up = 5) {
+    NOVA_ASSERT(period >= Time{1} && "the simulation can't step less than a millisecond");
+    std::chrono::nanoseconds next = clock.now();
+    // the time the ticks run so far should simulate, and what they simulated rounded to milliseconds.
+    std::chrono::nanoseconds exact{0};
+    Time simulated{0};
+    while (!stop()) {
+        for (std::size_t i = 0; i < max_catch_up && clock.now() >= std::chrono::ceil<Time>(next) && !stop(); ++i) {
+            exact += period;
+            auto const step = std::chrono::round<Time>(exact) - simulated;
+            simulated += step;
+            world.update(step);
+            next += period;
+        }
+        next = std::max(next, std::chrono::nanoseconds{clock.now()});
+        clock.sleepUntil(std::chrono::ceil<Time>(next));
+    }
+}
+
+} // namespace nova
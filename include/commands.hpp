@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "util.hpp"
+
+namespace nova {
+
+namespace detail {
+
+inline constexpr std::size_t command_alignment = 64;
+inline constexpr std::size_t command_block_size = 16 * 1024;
+
+struct command_header {
+    void (*apply)(void*, entt::registry&);
+    void (*destroy)(void*) noexcept;
+    std::uint32_t payload;
+    std::uint32_t next;
+};
+
+struct command_block {
+    std::byte* data;
+    std::size_t capacity;
+    std::size_t used;
+};
+
+constexpr std::size_t align_command(std::size_t const offset, std::size_t const alignment) noexcept {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace detail
+
+// Structural changes recorded while systems run in parallel and applied to the registry at the next
+// stage boundary, in the order they were recorded. Commands are stored in place in blocks that are kept
+// between flushes, so recording doesn't allocate once the buffer is warm.
+class Commands {
+    std::vector<detail::command_block> blocks_;
+    std::size_t current_ = 0;
+
+    static detail::command_block allocate(std::size_t const capacity) {
+        return {static_cast<std::byte*>(::operator new(capacity, std::align_val_t{detail::command_alignment})), capacity, 0};
+    }
+
+    void release() noexcept {
+        for (auto const& block : blocks_)
+            ::operator delete(block.data, std::align_val_t{detail::command_alignment});
+        blocks_.clear();
+    }
+
+    template<class F>
+    void record(F&& f) {
+        using fn_t = std::decay_t<F>;
+        static_assert(alignof(fn_t) <= detail::command_alignment);
+
+        auto const fits = [](detail::command_block const& block, std::size_t& header, std::size_t& payload) {
+            header = detail::align_command(block.used, alignof(detail::command_header));
+            payload = detail::align_command(header + sizeof(detail::command_header), alignof(fn_t));
+            return payload + sizeof(fn_t) <= block.capacity;
+        };
+
+        std::size_t header = 0;
+        std::size_t payload = 0;
+        while (current_ < blocks_.size() && !fits(blocks_[current_], header, payload))
+            ++current_;
+        if (current_ == blocks_.size()) {
+            auto const needed = detail::align_command(sizeof(detail::command_header), alignof(fn_t)) + sizeof(fn_t);
+            blocks_.push_back(allocate(std::max(detail::command_block_size, needed)));
+            fits(blocks_.back(), header, payload);
+        }
+
+        auto& block = blocks_[current_];
+        ::new (block.data + payload) fn_t(std::forward<F>(f));
+        ::new (block.data + header) detail::command_header{
+            [](void* p, entt::registry& r) { (*static_cast<fn_t*>(p))(r); },
+            [](void* p) noexcept { static_cast<fn_t*>(p)->~fn_t(); },
+            static_cast<std::uint32_t>(payload),
+            static_cast<std::uint32_t>(payload + sizeof(fn_t)),
+        };
+        block.used = payload + sizeof(fn_t);
+    }
+
+    template<class F>
+    void each(F&& f) {
+        for (std::size_t i = 0; i <= current_ && i < blocks_.size(); ++i) {
+            auto& block = blocks_[i];
+            for (std::size_t offset = 0; offset < block.used;) {
+                offset = detail::align_command(offset, alignof(detail::command_header));
+                auto* const header = reinterpret_cast<detail::command_header*>(block.data + offset);
+                f(*header, block.data + header->payload);
+                offset = header->next;
+            }
+        }
+    }
+
+public:
+    Commands() = default;
+
+    Commands(Commands&& other) noexcept
+        : blocks_(std::move(other.blocks_)), current_(std::exchange(other.current_, 0)) {}
+
+    Commands& operator=(Commands&& other) noexcept {
+        if (this != &other) {
+            clear();
+            release();
+            blocks_ = std::move(other.blocks_);
+            current_ = std::exchange(other.current_, 0);
+        }
+        return *this;
+    }
+
+    ~Commands() {
+        clear();
+        release();
+    }
+
+    bool empty() const noexcept {
+        return blocks_.empty() || (current_ == 0 && blocks_.front().used == 0);
+    }
+
+    // creates an entity with the given components.
+    template<class... Components>
+    void spawn(Components&&... components) {
+        record([... cs = std::forward<Components>(components)](entt::registry& r) mutable {
+            auto const e = r.create();
+            (r.emplace<std::decay_t<Components>>(e, std::move(cs)), ...);
+        });
+    }
+
+    void destroy(entt::entity const e) {
+        record([e](entt::registry& r) {
+            if (r.valid(e))
+                r.destroy(e);
+        });
+    }
+
+    // assigns or replaces the component of `e`, nothing happens if `e` was destroyed meanwhile.
+    template<class Component, class... Args>
+    void emplace(entt::entity const e, Args&&... args) {
+        record([e, c = Component{std::forward<Args>(args)...}](entt::registry& r) mutable {
+            if (r.valid(e))
+                r.emplace_or_replace<Component>(e, std::move(c));
+        });
+    }
+
+    template<class Component>
+    void remove(entt::entity const e) {
+        record([e](entt::registry& r) {
+            if (r.valid(e))
+                r.remove_if_exists<Component>(e);
+        });
+    }
+
+    // records any change, `f` is called with the registry.
+    template<class F>
+    void run(F&& f) {
+        record(std::forward<F>(f));
+    }
+
+    // applies every recorded command in order and clears the buffer.
+    void apply(entt::registry& r) {
+        each([&r](detail::command_header const& header, void* payload) { header.apply(payload, r); });
+        clear();
+    }
+
+    // drops the recorded commands, the blocks are kept.
+    void clear() noexcept {
+        each([](detail::command_header const& header, void* payload) { header.destroy(payload); });
+        for (auto& block : blocks_)
+            block.used = 0;
+        current_ = 0;
+    }
+};
+
+} // namespace nova
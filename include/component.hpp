@@ -1,7 +1,18 @@
 #pragma once
 
+#include <type_traits>
+
 namespace nova {
 
 struct component_base {};
 
+// components deriving from this are stored in fixed-size pages that never relocate (see storage.hpp).
+struct paged_component_base : component_base {};
+
+template<class T>
+struct is_paged_component : std::is_base_of<paged_component_base, T> {};
+
+template<class T>
+inline constexpr bool is_paged_component_v = is_paged_component<T>::value;
+
 } // namespace nova
\ No newline at end of file
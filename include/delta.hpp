@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "component.hpp"
+#include "entity.hpp"
+#include "meta.hpp"
+#include "storage.hpp"
+
+namespace nova {
+
+// A delta is a packed, native-endian byte stream:
+//   delta_header
+//   num_records times: delta_op, entity, then op specific payload
+//     entity_destroyed:  u16 version the slot was left with
+//     entity_created:    -
+//     component_removed: u8 component index
+//     component_added:   u8 component index, sizeof(C) bytes
+//     component_changed: u8 component index, u16 offset, u16 length, length bytes
+//     entity_recycled:   u32 number of destroyed entities to hand out again, the entity is null
+// Entity records come first, followed by the records of each pool in turn. Only undo deltas have
+// entity_recycled records, which take back what a tick pushed on the registry's list of destroyed entities.
+namespace detail {
+
+inline constexpr std::uint32_t delta_magic = 0x4c44564e; // "NVDL"
+
+enum class delta_op : std::uint8_t {
+    entity_destroyed,
+    entity_created,
+    component_removed,
+    component_added,
+    component_changed,
+    entity_recycled,
+};
+
+struct delta_header {
+    std::uint32_t magic;
+    std::uint32_t schema;
+    std::uint64_t tick;
+    std::uint32_t num_records;
+};
+
+using entity_traits = entt::entt_traits<std::underlying_type_t<Entity>>;
+
+inline bool is_alive_at(Entity const e, std::size_t const pos) noexcept {
+    return entity_index(e) == pos;
+}
+
+inline std::uint16_t entity_version(Entity const e) noexcept {
+    return static_cast<std::uint16_t>(entt::to_integral(e) >> entity_traits::entity_shift);
+}
+
+inline Entity entity_at(std::size_t const pos, std::uint16_t const version) noexcept {
+    using underlying = std::underlying_type_t<Entity>;
+    return Entity{static_cast<underlying>(pos) | (static_cast<underlying>(version) << entity_traits::entity_shift)};
+}
+
+// sparse sets only compare the entity index, this also checks the version.
+inline bool contains_exact(entt::sparse_set<Entity> const& set, Entity const e) {
+    return set.contains(e) && set.data()[set.index(e)] == e;
+}
+
+class delta_writer {
+    std::vector<std::byte>& out_;
+    std::size_t header_offset_;
+    std::uint32_t num_records_ = 0;
+
+public:
+    delta_writer(std::vector<std::byte>& out, std::uint32_t const schema, std::uint64_t const tick)
+        : out_(out), header_offset_(out.size())
+    {
+        put(delta_header{delta_magic, schema, tick, 0});
+    }
+
+    delta_writer(delta_writer const&) = delete;
+    delta_writer& operator=(delta_writer const&) = delete;
+
+    ~delta_writer() {
+        std::memcpy(out_.data() + header_offset_ + offsetof(delta_header, num_records), &num_records_, sizeof(num_records_));
+    }
+
+    void bytes(void const* const data, std::size_t const size) {
+        auto const offset = out_.size();
+        out_.resize(offset + size);
+        std::memcpy(out_.data() + offset, data, size);
+    }
+
+    template<class T>
+    void put(T const& v) {
+        bytes(&v, sizeof(T));
+    }
+
+    void record(delta_op const op, Entity const e) {
+        ++num_records_;
+        put(op);
+        put(e);
+    }
+};
+
+class delta_reader {
+    std::span<std::byte const> in_;
+    std::size_t offset_ = 0;
+
+public:
+    explicit delta_reader(std::span<std::byte const> in) noexcept : in_(in) {}
+
+    // returns nullptr if the delta is truncated.
+    std::byte const* bytes(std::size_t const size) noexcept {
+        if (in_.size() - offset_ < size)
+            return nullptr;
+        auto const* const p = in_.data() + offset_;
+        offset_ += size;
+        return p;
+    }
+
+    template<class T>
+    bool get(T& v) noexcept {
+        auto const* const p = bytes(sizeof(T));
+        if (p != nullptr)
+            std::memcpy(&v, p, sizeof(T));
+        return p != nullptr;
+    }
+};
+
+} // namespace detail
+
+// Records per-tick deltas of a registry: entities created and destroyed, and components of the given
+// types added, removed or changed. Changes are found by diffing each pool against a shadow copy kept
+// from the previous record, a changed component only carries the span of bytes that differ.
+// Only list the components that can change during a tick, see SystemsDeltaRecorder.
+//
+// A record can also produce the undo delta of the tick, which `rewind` applies to go back to the previous
+// state in time proportional to what changed rather than to the size of the world.
+template<class... Components>
+requires std::conjunction_v<std::is_base_of<component_base, Components>..., std::is_trivially_copyable<Components>...>
+    && (sizeof...(Components) <= 256)
+class DeltaRecorder {
+    static_assert(((sizeof(Components) <= std::numeric_limits<std::uint16_t>::max()) && ...),
+                  "the changed bytes of a component are recorded with 16-bit offsets and lengths");
+
+    static constexpr std::size_t entity_chunk = 64;
+
+    std::vector<Entity> entities_;
+    std::vector<Entity> prev_entities_;
+    // the number of destroyed entities in the registry at the last record.
+    std::size_t free_ = 0;
+    std::tuple<entt::storage<Entity, Components>...> shadows_;
+
+    // scratch buffers reused between records
+    std::vector<std::pair<Entity, std::uint16_t>> destroyed_;
+    std::vector<Entity> created_;
+    std::vector<Entity> removed_;
+    std::vector<std::size_t> changed_;
+    std::vector<std::size_t> recycled_;
+    std::vector<std::size_t> links_;
+    std::vector<std::size_t> order_;
+
+    static constexpr std::uint32_t computeSchema() noexcept {
+        std::uint32_t schema = 2166136261u;
+        ((schema = (schema ^ entt::type_info<Components>::id()) * 16777619u, schema = (schema ^ sizeof(Components)) * 16777619u), ...);
+        return schema;
+    }
+
+    bool existedBefore(Entity const e) const noexcept {
+        auto const pos = detail::entity_index(e);
+        return pos < prev_entities_.size() && prev_entities_[pos] == e;
+    }
+
+    void diffSlot(std::size_t const pos, Entity const prev, Entity const curr) {
+        if (prev == curr)
+            return;
+        changed_.push_back(pos);
+        if (detail::is_alive_at(prev, pos))
+            destroyed_.emplace_back(prev, detail::entity_version(curr));
+        if (detail::is_alive_at(curr, pos))
+            created_.push_back(curr);
+    }
+
+    // puts the slots in `recycled_` in the order they had on the registry's list of destroyed entities at the last
+    // record, where each one links to the next.
+    void orderRecycled() {
+        auto const& prev = prev_entities_;
+        std::sort(recycled_.begin(), recycled_.end());
+        links_.clear();
+        for (auto const pos : recycled_)
+            links_.push_back(detail::entity_index(prev[pos]));
+        std::sort(links_.begin(), links_.end());
+
+        auto const listed = [](std::vector<std::size_t> const& slots, std::size_t const pos) {
+            return std::binary_search(slots.begin(), slots.end(), pos);
+        };
+        // the first slot is the one no other slot links to.
+        auto const first = std::find_if(recycled_.begin(), recycled_.end(), [this, &listed](std::size_t const pos) {
+            return !listed(links_, pos);
+        });
+        order_.clear();
+        for (auto pos = first == recycled_.end() ? detail::entity_index(entt::null) : *first;
+             order_.size() < recycled_.size() && listed(recycled_, pos);
+             pos = detail::entity_index(prev[pos]))
+            order_.push_back(pos);
+        recycled_.swap(order_);
+    }
+
+    void diffEntities(entt::registry const& r, detail::delta_writer& w, detail::delta_writer* const u) {
+        destroyed_.clear();
+        created_.clear();
+        changed_.clear();
+
+        auto const* const curr = r.data();
+        auto const size = r.size();
+        entities_.swap(prev_entities_);
+        auto const& prev = prev_entities_;
+        auto const common = std::min(size, prev.size());
+
+        // most slots don't change between ticks, compare whole chunks before looking at single slots.
+        for (std::size_t base = 0; base < common; base += entity_chunk) {
+            auto const count = std::min(entity_chunk, common - base);
+            if (std::memcmp(curr + base, prev.data() + base, count * sizeof(Entity)) == 0)
+                continue;
+            for (auto pos = base; pos < base + count; ++pos)
+                diffSlot(pos, prev[pos], curr[pos]);
+        }
+        for (auto pos = common; pos < size; ++pos) {
+            if (detail::is_alive_at(curr[pos], pos))
+                created_.push_back(curr[pos]);
+        }
+        entities_.assign(curr, curr + size);
+
+        for (auto const& [e, version] : destroyed_) {
+            w.record(detail::delta_op::entity_destroyed, e);
+            w.put(version);
+        }
+        for (auto const e : created_)
+            w.record(detail::delta_op::entity_created, e);
+
+        auto const prev_free = free_;
+        std::uint32_t pushed = 0;
+        recycled_.clear();
+        for (auto const pos : changed_) {
+            if (!detail::is_alive_at(curr[pos], pos))
+                ++pushed;
+            if (!detail::is_alive_at(prev[pos], pos))
+                recycled_.push_back(pos);
+        }
+        for (auto pos = common; pos < size; ++pos) {
+            if (!detail::is_alive_at(curr[pos], pos))
+                ++pushed;
+        }
+        free_ = prev_free - recycled_.size() + pushed;
+
+        if (u == nullptr)
+            return;
+
+        // A tick only pushes entities on the front of the registry's list of destroyed entities and hands out the
+        // ones at its front, so the undo goes through the registry's interface: the slots the tick pushed are
+        // handed out again, entities it destroyed come back with their old version, and the slots it handed out
+        // are pushed back in their old order, which destroys entities it created along with their components.
+        // Slots appended during the tick can't be cut off again, they're pushed behind the old list with the
+        // first version, which hands them out just like new slots. Appending a slot with a hint doesn't empty
+        // the list first, the whole list is put back then.
+        if (size > prev.size() && recycled_.size() < prev_free) {
+            pushed = static_cast<std::uint32_t>(free_);
+            recycled_.clear();
+            for (std::size_t pos = 0; pos < prev.size(); ++pos) {
+                if (!detail::is_alive_at(prev[pos], pos))
+                    recycled_.push_back(pos);
+            }
+        }
+        orderRecycled();
+
+        auto const current = [curr](std::size_t const pos) {
+            return detail::entity_at(pos, detail::entity_version(curr[pos]));
+        };
+        u->record(detail::delta_op::entity_recycled, entt::null);
+        u->put(pushed);
+        for (auto const pos : changed_) {
+            if (detail::is_alive_at(prev[pos], pos)) {
+                u->record(detail::delta_op::entity_destroyed, current(pos));
+                u->put(detail::entity_version(prev[pos]));
+                u->record(detail::delta_op::entity_created, prev[pos]);
+            }
+        }
+        for (auto pos = size; pos-- > common;) {
+            u->record(detail::delta_op::entity_destroyed, current(pos));
+            u->put(std::uint16_t{0});
+        }
+        for (auto it = recycled_.rbegin(); it != recycled_.rend(); ++it) {
+            u->record(detail::delta_op::entity_destroyed, current(*it));
+            u->put(detail::entity_version(prev[*it]));
+        }
+    }
+
+    template<std::size_t I, class C>
+    void diffPool(entt::registry const& r, detail::delta_writer& w, detail::delta_writer* const u) {
+        auto& shadow = std::get<I>(shadows_);
+        auto const index = static_cast<std::uint8_t>(I);
+
+        removed_.clear();
+        for (auto const e : static_cast<entt::sparse_set<Entity> const&>(shadow)) {
+            if (!r.valid(e) || !r.has<C>(e))
+                removed_.push_back(e);
+        }
+        for (auto const e : removed_) {
+            // components of destroyed entities go away with the entity_destroyed record.
+            if (r.valid(e)) {
+                w.record(detail::delta_op::component_removed, e);
+                w.put(index);
+            }
+            if (u != nullptr) {
+                u->record(detail::delta_op::component_added, e);
+                u->put(index);
+                if constexpr (!std::is_empty_v<C>)
+                    u->bytes(&shadow.get(e), sizeof(C));
+            }
+            shadow.erase(e);
+        }
+
+        auto const added = [this, &shadow, &w, u, index](Entity const e, [[maybe_unused]] std::byte const* const curr) {
+            w.record(detail::delta_op::component_added, e);
+            w.put(index);
+            if constexpr (!std::is_empty_v<C>)
+                w.bytes(curr, sizeof(C));
+            // components of created entities go away with the entity_destroyed record.
+            if (u != nullptr && existedBefore(e)) {
+                u->record(detail::delta_op::component_removed, e);
+                u->put(index);
+            }
+        };
+
+        if constexpr (std::is_empty_v<C>) {
+            for (auto const e : r.view<C const>()) {
+                if (!detail::contains_exact(shadow, e)) {
+                    added(e, nullptr);
+                    shadow.emplace(e);
+                }
+            }
+        }
+        else {
+            r.view<C const>().each([&shadow, &w, &added, u, index](auto const e, C const& c) {
+                auto const* const curr = reinterpret_cast<std::byte const*>(&c);
+                if (!detail::contains_exact(shadow, e)) {
+                    added(e, curr);
+                    shadow.emplace(e, c);
+                    return;
+                }
+                auto* const prev = reinterpret_cast<std::byte*>(&shadow.get(e));
+                if (std::memcmp(prev, curr, sizeof(C)) == 0)
+                    return;
+                std::size_t first = 0;
+                std::size_t last = sizeof(C);
+                while (prev[first] == curr[first])
+                    ++first;
+                while (prev[last - 1] == curr[last - 1])
+                    --last;
+                w.record(detail::delta_op::component_changed, e);
+                w.put(index);
+                w.put(static_cast<std::uint16_t>(first));
+                w.put(static_cast<std::uint16_t>(last - first));
+                w.bytes(curr + first, last - first);
+                if (u != nullptr) {
+                    u->record(detail::delta_op::component_changed, e);
+                    u->put(index);
+                    u->put(static_cast<std::uint16_t>(first));
+                    u->put(static_cast<std::uint16_t>(last - first));
+                    u->bytes(prev + first, last - first);
+                }
+                std::memcpy(prev + first, curr + first, last - first);
+            });
+        }
+    }
+
+    template<std::size_t... Is>
+    void diffPools(entt::registry const& r, detail::delta_writer& w, detail::delta_writer* const u, std::index_sequence<Is...>) {
+        (diffPool<Is, Components>(r, w, u), ...);
+    }
+
+    template<class Func, std::size_t... Is>
+    static bool visitComponent(std::uint8_t const index, Func&& func, std::index_sequence<Is...>) {
+        return ((index == Is ? func.template operator()<Components>() : false) || ...);
+    }
+
+    struct registry_target {
+        entt::registry& r;
+
+        void destroy(Entity const e, std::uint16_t const version) {
+            r.destroy(e, version);
+        }
+
+        void create(Entity const e) {
+            r.create(e);
+        }
+
+        bool recycle(std::uint32_t const count) {
+            if (count > r.size() - r.alive())
+                return false;
+            for (std::uint32_t i = 0; i < count; ++i)
+                r.create();
+            return true;
+        }
+
+        template<class C>
+        void remove(Entity const e) {
+            r.remove<C>(e);
+        }
+
+        template<class C>
+        void add(Entity const e, [[maybe_unused]] std::byte const* const bytes) {
+            if constexpr (std::is_empty_v<C>)
+                r.emplace<C>(e);
+            else {
+                C value;
+                std::memcpy(&value, bytes, sizeof(C));
+                r.emplace<C>(e, value);
+            }
+        }
+
+        template<class C>
+        void change(Entity const e, std::uint16_t const offset, std::uint16_t const length, std::byte const* const bytes) {
+            r.patch<C>(e, [bytes, offset, length](C& c) {
+                std::memcpy(reinterpret_cast<std::byte*>(&c) + offset, bytes, length);
+            });
+        }
+    };
+
+    // applies a delta to the registry and the shadow pools alike.
+    struct rewind_target : registry_target {
+        std::tuple<entt::storage<Entity, Components>...>& shadows;
+
+        void destroy(Entity const e, std::uint16_t const version) {
+            registry_target::destroy(e, version);
+            std::apply([e](auto&... shadow) {
+                ((detail::contains_exact(shadow, e) ? shadow.erase(e) : void()), ...);
+            }, shadows);
+        }
+
+        template<class C>
+        void remove(Entity const e) {
+            registry_target::template remove<C>(e);
+            std::get<entt::storage<Entity, C>>(shadows).erase(e);
+        }
+
+        template<class C>
+        void add(Entity const e, std::byte const* const bytes) {
+            registry_target::template add<C>(e, bytes);
+            if constexpr (std::is_empty_v<C>)
+                std::get<entt::storage<Entity, C>>(shadows).emplace(e);
+            else
+                std::get<entt::storage<Entity, C>>(shadows).emplace(e, registry_target::r.template get<C>(e));
+        }
+
+        template<class C>
+        void change(Entity const e, std::uint16_t const offset, std::uint16_t const length, std::byte const* const bytes) {
+            registry_target::template change<C>(e, offset, length, bytes);
+            std::memcpy(reinterpret_cast<std::byte*>(&std::get<entt::storage<Entity, C>>(shadows).get(e)) + offset, bytes, length);
+        }
+    };
+
+    template<class Target>
+    static bool decode(std::span<std::byte const> delta, Target& target) {
+        detail::delta_reader reader{delta};
+        detail::delta_header header{};
+        if (!reader.get(header) || header.magic != detail::delta_magic || header.schema != schema)
+            return false;
+
+        for (std::uint32_t i = 0; i < header.num_records; ++i) {
+            detail::delta_op op{};
+            Entity e{};
+            std::uint8_t index{};
+            if (!reader.get(op) || !reader.get(e))
+                return false;
+
+            switch (op) {
+            case detail::delta_op::entity_destroyed: {
+                std::uint16_t version{};
+                if (!reader.get(version))
+                    return false;
+                target.destroy(e, version);
+                break;
+            }
+            case detail::delta_op::entity_created:
+                target.create(e);
+                break;
+            case detail::delta_op::entity_recycled: {
+                std::uint32_t count{};
+                if (!reader.get(count) || !target.recycle(count))
+                    return false;
+                break;
+            }
+            case detail::delta_op::component_removed:
+                if (!reader.get(index) || !visitComponent(index, [&target, e]<class C>() {
+                        target.template remove<C>(e);
+                        return true;
+                    }, std::index_sequence_for<Components...>{}))
+                    return false;
+                break;
+            case detail::delta_op::component_added:
+                if (!reader.get(index) || !visitComponent(index, [&target, &reader, e]<class C>() {
+                        auto const* const bytes = reader.bytes(std::is_empty_v<C> ? 0 : sizeof(C));
+                        if (bytes != nullptr)
+                            target.template add<C>(e, bytes);
+                        return bytes != nullptr;
+                    }, std::index_sequence_for<Components...>{}))
+                    return false;
+                break;
+            case detail::delta_op::component_changed: {
+                std::uint16_t offset{};
+                std::uint16_t length{};
+                if (!reader.get(index) || !reader.get(offset) || !reader.get(length))
+                    return false;
+                auto const* const bytes = reader.bytes(length);
+                if (bytes == nullptr || !visitComponent(index, [&target, e, bytes, offset, length]<class C>() {
+                        if constexpr (std::is_empty_v<C>)
+                            return false;
+                        else if (offset + length > sizeof(C))
+                            return false;
+                        else {
+                            target.template change<C>(e, offset, length, bytes);
+                            return true;
+                        }
+                    }, std::index_sequence_for<Components...>{}))
+                    return false;
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    static constexpr std::uint32_t schema = computeSchema();
+
+    // takes the current state of `r` as the baseline of the next record.
+    void reset(entt::registry const& r) {
+        entities_.clear();
+        free_ = 0;
+        std::apply([](auto&... shadow) { (shadow.clear(), ...); }, shadows_);
+        std::vector<std::byte> discard;
+        record(r, 0, discard);
+    }
+
+    // appends the delta between the previous record and the current state of `r` to `out`,
+    // and the delta that undoes it to `undo` if given.
+    void record(entt::registry const& r, std::uint64_t const tick, std::vector<std::byte>& out, std::vector<std::byte>* const undo = nullptr) {
+        detail::delta_writer w{out, schema, tick};
+        std::optional<detail::delta_writer> u;
+        if (undo != nullptr)
+            u.emplace(*undo, schema, tick);
+        auto* const up = u ? &*u : nullptr;
+        diffEntities(r, w, up);
+        diffPools(r, w, up, std::index_sequence_for<Components...>{});
+    }
+
+    // applies an undo delta from `record` to `r` and moves the baseline back with it,
+    // undo deltas must be rewound newest first.
+    bool rewind(entt::registry& r, std::span<std::byte const> undo) {
+        rewind_target target{{r}, shadows_};
+        if (!decode(undo, target))
+            return false;
+        entities_.assign(r.data(), r.data() + r.size());
+        free_ = r.size() - r.alive();
+        return true;
+    }
+
+    // applies a delta recorded by this recorder type, returns false if it is malformed or has another schema.
+    static bool apply(entt::registry& r, std::span<std::byte const> delta) {
+        registry_target target{r};
+        return decode(delta, target);
+    }
+};
+
+namespace detail {
+
+template<class Components, class... Pending>
+struct delta_recorder_of;
+
+// adds the pending components one at a time, so a component several systems write is recorded once.
+template<class... Components, class Head, class... Tail>
+struct delta_recorder_of<meta::sink<Components...>, Head, Tail...>
+    : delta_recorder_of<meta::unique_concat_t<meta::sink<Components...>, Head>, Tail...> {};
+
+template<class... Components>
+struct delta_recorder_of<meta::sink<Components...>> {
+    using type = DeltaRecorder<Components...>;
+};
+
+template<class Sink>
+struct systems_delta_recorder;
+
+template<class... Components>
+struct systems_delta_recorder<meta::sink<Components...>> : delta_recorder_of<meta::sink<>, Components...> {};
+
+} // namespace detail
+
+// a DeltaRecorder for every component the given systems declare in Write<>.
+template<class... Systems>
+using SystemsDeltaRecorder = typename detail::systems_delta_recorder<
+    meta::sink_cat_t<typename Systems::write_components...>>::type;
+
+} // namespace nova
\ No newline at end of file
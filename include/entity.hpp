@@ -1,9 +1,104 @@
 #pragma once
 
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
 #include "../deps/entt/single_include/entt/entt.hpp"
 
+#include "util.hpp"
+
 namespace nova {
 
 using Entity = entt::entity;
 
-} // namespace nova
\ No newline at end of file
+namespace detail {
+
+// the index part of an entity, which is its slot in the registry.
+inline std::size_t entity_index(Entity const e) noexcept {
+    return entt::to_integral(e) & entt::entt_traits<std::underlying_type_t<Entity>>::entity_mask;
+}
+
+} // namespace detail
+
+// Tells Worlds apart, 0 is never used by a World.
+using WorldId = std::uint32_t;
+
+// An entity together with the World it belongs to. The entity's version is its generation, so a handle to a
+// destroyed entity stays invalid once the World reuses its index.
+struct Handle {
+    WorldId world = 0;
+    Entity entity = entt::null;
+
+    explicit operator bool() const noexcept {
+        return world != 0 && entity != entt::null;
+    }
+
+    friend bool operator==(Handle const&, Handle const&) noexcept = default;
+};
+
+// An entity reference packed in 32 bits, the index in the low bits and the version in the high bits, for
+// components holding many references to entities of their own World such as inventories or parent links.
+// With 32-bit entities this is the entity itself, with 64-bit entities it keeps the low bits of the version,
+// which still tells a reused index apart unless the slot was recycled a multiple of 4096 times meanwhile.
+class PackedEntity {
+public:
+    static constexpr std::uint32_t index_bits = 20;
+    static constexpr std::uint32_t index_mask = (1u << index_bits) - 1;
+    static constexpr std::uint32_t version_mask = (1u << (32 - index_bits)) - 1;
+
+private:
+    using traits_type = entt::entt_traits<std::underlying_type_t<Entity>>;
+
+    static constexpr std::uint32_t null_value = ~std::uint32_t{0};
+
+    std::uint32_t value_ = null_value;
+
+public:
+    constexpr PackedEntity() noexcept = default;
+
+    // the index must fit in `index_bits`.
+    explicit PackedEntity(Entity const e) noexcept {
+        if (e == entt::null)
+            return;
+        auto const index = entt::to_integral(e) & traits_type::entity_mask;
+        auto const version = entt::to_integral(e) >> traits_type::entity_shift;
+        NOVA_ASSERT(index <= index_mask && "the entity index doesn't fit in a packed entity");
+        value_ = static_cast<std::uint32_t>(index) | (static_cast<std::uint32_t>(version & version_mask) << index_bits);
+    }
+
+    std::uint32_t index() const noexcept {
+        return value_ & index_mask;
+    }
+
+    std::uint32_t version() const noexcept {
+        return value_ >> index_bits;
+    }
+
+    explicit operator bool() const noexcept {
+        return value_ != null_value;
+    }
+
+    // whether the entity referred to is still alive in `r`.
+    bool valid(entt::registry const& r) const {
+        if (!*this || index() >= r.size())
+            return false;
+        auto const current = r.current(Entity{static_cast<traits_type::entity_type>(index())});
+        return (current & version_mask) == version() && r.valid(unpack(r));
+    }
+
+    // the full entity as `r` knows it, only meaningful while the reference is valid.
+    Entity unpack(entt::registry const& r) const {
+        if (!*this)
+            return entt::null;
+        auto const index = static_cast<traits_type::entity_type>(this->index());
+        return Entity{index | (static_cast<traits_type::entity_type>(r.current(Entity{index})) << traits_type::entity_shift)};
+    }
+
+    friend bool operator==(PackedEntity const&, PackedEntity const&) noexcept = default;
+};
+
+static_assert(sizeof(PackedEntity) == 4);
+
+} // namespace nova
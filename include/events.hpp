@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "util.hpp"
+
+namespace nova {
+
+namespace detail {
+
+struct event_channel {
+    virtual ~event_channel() = default;
+    virtual void swap() noexcept = 0;
+};
+
+// every channel of a registry, kept in its context so the World can swap them at the end of a tick.
+struct event_channels {
+    std::vector<event_channel*> channels;
+
+    void swap() noexcept {
+        for (auto* const channel : channels)
+            channel->swap();
+    }
+};
+
+} // namespace detail
+
+// The events a reader hasn't seen yet, oldest first.
+template<class E>
+struct EventSpan {
+    std::span<E const> older;
+    std::span<E const> newer;
+
+    std::size_t size() const noexcept {
+        return older.size() + newer.size();
+    }
+
+    bool empty() const noexcept {
+        return older.empty() && newer.empty();
+    }
+
+    template<class F>
+    void each(F&& f) const {
+        for (auto const& e : older)
+            f(e);
+        for (auto const& e : newer)
+            f(e);
+    }
+};
+
+// A typed channel kept in the registry context. Systems declaring EventWriter<E> append to buffers of their own
+// while they run, which are moved into the channel at the end of their stage in the order the systems ran, so
+// sending never locks and never touches the registry. The channel is double buffered: events are kept for the
+// tick they were sent in and the next one, so every reader sees each event once whatever its stage.
+template<class E>
+class Events final : public detail::event_channel {
+    std::vector<E> previous_;
+    std::vector<E> current_;
+    // the sequence number of the first event of `previous_`.
+    std::uint64_t first_ = 0;
+
+public:
+    // the sequence number the next event gets.
+    std::uint64_t end() const noexcept {
+        return first_ + previous_.size() + current_.size();
+    }
+
+    void push(E event) {
+        current_.push_back(std::move(event));
+    }
+
+    // moves the events out of `events`, which keeps its capacity.
+    void append(std::vector<E>& events) {
+        current_.insert(current_.end(), std::make_move_iterator(events.begin()), std::make_move_iterator(events.end()));
+        events.clear();
+    }
+
+    // the events from sequence number `from` on.
+    EventSpan<E> since(std::uint64_t const from) const noexcept {
+        auto const middle = first_ + previous_.size();
+        auto const skip = [from](std::uint64_t const first, std::size_t const size) {
+            return from > first ? static_cast<std::size_t>(std::min<std::uint64_t>(from - first, size)) : 0;
+        };
+        auto const older = std::span<E const>{previous_}.subspan(skip(first_, previous_.size()));
+        auto const newer = std::span<E const>{current_}.subspan(skip(middle, current_.size()));
+        return {older, newer};
+    }
+
+    // drops the events of the previous tick, the buffers are reused.
+    void swap() noexcept final {
+        first_ += previous_.size();
+        previous_.swap(current_);
+        current_.clear();
+    }
+};
+
+// the channel of E in `r`, created the first time it is asked for.
+template<class E>
+Events<E>& events(entt::registry& r) {
+    if (auto* const channel = r.try_ctx<Events<E>>())
+        return *channel;
+    auto& channel = r.set<Events<E>>();
+    r.ctx_or_set<detail::event_channels>().channels.push_back(&channel);
+    return channel;
+}
+
+} // namespace nova
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "component.hpp"
+#include "entity.hpp"
+#include "util.hpp"
+
+namespace nova {
+
+// Links an entity to its parent and its children. Entities with no parent are the roots of their hierarchy.
+// Change the links through `attach` and `detach` only, they keep the pool marked for sorting.
+struct Relationship : component_base {
+    Entity parent = entt::null;
+    Entity first_child = entt::null;
+    Entity next_sibling = entt::null;
+};
+
+namespace detail {
+
+inline constexpr std::uint32_t no_parent = static_cast<std::uint32_t>(-1);
+
+// Kept in the registry context. Once sorted, the Relationship pool iterates depth-first, every parent before
+// its children, and `parents` holds the position of each node's parent in that order.
+struct hierarchy_state {
+    bool sorted = false;
+    std::vector<std::uint32_t> parents;
+};
+
+inline void unsort_hierarchy(entt::registry& r, Entity) {
+    r.ctx<hierarchy_state>().sorted = false;
+}
+
+inline void unlink(entt::registry& r, Entity const child) {
+    auto& rel = r.get<Relationship>(child);
+    if (rel.parent == entt::null)
+        return;
+    auto* link = &r.get<Relationship>(rel.parent).first_child;
+    while (*link != child)
+        link = &r.get<Relationship>(*link).next_sibling;
+    *link = rel.next_sibling;
+    rel.parent = entt::null;
+    rel.next_sibling = entt::null;
+}
+
+// a destroyed node leaves its parent and its children become roots.
+inline void orphan(entt::registry& r, Entity const e) {
+    unlink(r, e);
+    for (auto child = r.get<Relationship>(e).first_child; child != entt::null;) {
+        auto& rel = r.get<Relationship>(child);
+        child = std::exchange(rel.next_sibling, entt::null);
+        rel.parent = entt::null;
+    }
+    r.ctx<hierarchy_state>().sorted = false;
+}
+
+inline hierarchy_state& hierarchy(entt::registry& r) {
+    if (auto* const state = r.try_ctx<hierarchy_state>())
+        return *state;
+    r.on_construct<Relationship>().connect<&unsort_hierarchy>();
+    r.on_destroy<Relationship>().connect<&orphan>();
+    return r.set<hierarchy_state>();
+}
+
+} // namespace detail
+
+// makes `child` the first child of `parent`, detaching it from its previous parent.
+inline void attach(entt::registry& r, Entity const child, Entity const parent) {
+    auto& state = detail::hierarchy(r);
+    r.get_or_emplace<Relationship>(child);
+    r.get_or_emplace<Relationship>(parent);
+    for (auto e = parent; e != entt::null; e = r.get<Relationship>(e).parent)
+        NOVA_ASSERT(e != child && "an entity can't be attached below itself");
+
+    detail::unlink(r, child);
+    auto& rel = r.get<Relationship>(child);
+    auto& parent_rel = r.get<Relationship>(parent);
+    rel.parent = parent;
+    rel.next_sibling = std::exchange(parent_rel.first_child, child);
+    state.sorted = false;
+}
+
+// makes `child` the root of its own hierarchy, it keeps its children.
+inline void detach(entt::registry& r, Entity const child) {
+    auto& state = detail::hierarchy(r);
+    if (!r.has<Relationship>(child))
+        return;
+    detail::unlink(r, child);
+    state.sorted = false;
+}
+
+// Sorts the Relationship pool depth-first, a no-op unless links changed since the last sort.
+inline void sortHierarchy(entt::registry& r) {
+    auto& state = detail::hierarchy(r);
+    if (state.sorted)
+        return;
+
+    auto const nodes = r.view<Relationship>();
+    std::vector<std::uint32_t> rank(r.size(), 0);
+    std::uint32_t next = 0;
+    for (auto const root : nodes) {
+        if (nodes.get(root).parent != entt::null)
+            continue;
+        // a preorder walk that climbs back through the parent links, so no stack is needed.
+        for (auto e = root;;) {
+            rank[detail::entity_index(e)] = next++;
+            auto const& rel = nodes.get(e);
+            if (rel.first_child != entt::null) {
+                e = rel.first_child;
+                continue;
+            }
+            while (e != root && nodes.get(e).next_sibling == entt::null)
+                e = nodes.get(e).parent;
+            if (e == root)
+                break;
+            e = nodes.get(e).next_sibling;
+        }
+    }
+
+    r.sort<Relationship>([&rank](Entity const a, Entity const b) {
+        return rank[detail::entity_index(a)] < rank[detail::entity_index(b)];
+    });
+
+    state.parents.clear();
+    state.parents.reserve(next);
+    for (auto const e : nodes) {
+        auto const parent = nodes.get(e).parent;
+        state.parents.push_back(parent == entt::null ? detail::no_parent : rank[detail::entity_index(parent)]);
+    }
+    state.sorted = true;
+}
+
+// Calls `f(parent, child)` with the T of every node that has a parent, parents before their children, e.g. to
+// compute world transforms from local ones. Every node of the hierarchy must have a T. The T pool is put in the
+// order of the Relationship pool first, so the pass walks both arrays linearly.
+template<class T, class F>
+void propagate(entt::registry& r, F&& f) {
+    static_assert(!is_paged_component_v<T>, "paged components can't be sorted");
+    sortHierarchy(r);
+    auto const& parents = r.ctx<detail::hierarchy_state>().parents;
+    [[maybe_unused]] auto const missing = r.view<Relationship>(entt::exclude<T>);
+    NOVA_ASSERT(missing.begin() == missing.end() && "every node of the hierarchy must have the component");
+
+    r.sort<T, Relationship>();
+    // pools iterate from the end of their arrays and the nodes are iterated first, so node k is at `last - k`.
+    auto* const data = r.raw<T>();
+    auto const last = r.size<T>() - 1;
+    for (std::size_t k = 0; k < parents.size(); ++k) {
+        if (parents[k] != detail::no_parent)
+            f(std::as_const(data[last - parents[k]]), data[last - k]);
+    }
+}
+
+} // namespace nova
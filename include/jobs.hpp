@@ -0,0 +1,374 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "task.hpp"
+#include "util.hpp"
+
+namespace nova {
+
+enum class JobPriority : std::uint8_t {
+    High,
+    Normal,
+    Low,
+};
+
+namespace detail {
+
+inline constexpr std::size_t num_job_priorities = 3;
+
+template<class T>
+using job_result_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+template<class T>
+struct job_state {
+    std::atomic<bool> ready{false};
+    std::optional<job_result_t<T>> value;
+};
+
+// a move-only type-erased job.
+class job {
+    struct base {
+        virtual ~base() = default;
+        virtual void run() = 0;
+    };
+
+    template<class F>
+    struct impl final : base {
+        F f;
+
+        explicit impl(F&& fn) : f(std::move(fn)) {}
+
+        void run() final {
+            f();
+        }
+    };
+
+    std::unique_ptr<base> impl_;
+
+public:
+    job() noexcept = default;
+
+    template<class F>
+    requires (!std::is_same_v<std::decay_t<F>, job>)
+    explicit job(F&& f) : impl_(std::make_unique<impl<std::decay_t<F>>>(std::forward<F>(f))) {}
+
+    explicit operator bool() const noexcept {
+        return static_cast<bool>(impl_);
+    }
+
+    void operator()() {
+        impl_->run();
+    }
+};
+
+// One worker's jobs, a deque per priority. The owner takes the newest job, thieves take the oldest.
+class job_deque {
+    std::mutex mutex_;
+    std::array<std::deque<job>, num_job_priorities> jobs_;
+
+public:
+    void push(JobPriority const priority, job j) {
+        std::lock_guard const lock{mutex_};
+        jobs_[static_cast<std::size_t>(priority)].push_back(std::move(j));
+    }
+
+    job pop() {
+        std::lock_guard const lock{mutex_};
+        for (auto& jobs : jobs_) {
+            if (!jobs.empty()) {
+                auto j = std::move(jobs.back());
+                jobs.pop_back();
+                return j;
+            }
+        }
+        return {};
+    }
+
+    job steal() {
+        std::lock_guard const lock{mutex_};
+        for (auto& jobs : jobs_) {
+            if (!jobs.empty()) {
+                auto j = std::move(jobs.front());
+                jobs.pop_front();
+                return j;
+            }
+        }
+        return {};
+    }
+};
+
+} // namespace detail
+
+// The result of a job. It can be polled, waited on through JobSystem::wait, or awaited by a Task,
+// which is then resumed on the first tick after the job finished.
+template<class T>
+class Future {
+    std::shared_ptr<detail::job_state<T>> state_;
+
+public:
+    using value_type = T;
+
+    Future() noexcept = default;
+
+    explicit Future(std::shared_ptr<detail::job_state<T>> state) noexcept : state_(std::move(state)) {}
+
+    bool valid() const noexcept {
+        return static_cast<bool>(state_);
+    }
+
+    bool ready() const noexcept {
+        return state_->ready.load(std::memory_order_acquire);
+    }
+
+    // moves the result out, the job must have finished.
+    detail::job_result_t<T> get() {
+        NOVA_ASSERT(ready());
+        return std::move(*state_->value);
+    }
+
+    auto operator co_await() const noexcept {
+        struct awaiter {
+            std::shared_ptr<detail::job_state<T>> state;
+            Task::handle_type handle;
+
+            bool await_ready() const noexcept {
+                return state->ready.load(std::memory_order_acquire);
+            }
+
+            void await_suspend(Task::handle_type const h) noexcept {
+                handle = h;
+                auto& promise = h.promise();
+                promise.wait_for = &state->ready;
+                promise.wake_tick = promise.scheduler->tick() + 1;
+            }
+
+            T await_resume() {
+                if (handle)
+                    handle.promise().wait_for = nullptr;
+                if constexpr (!std::is_void_v<T>)
+                    return std::move(*state->value);
+            }
+        };
+        return awaiter{state_, nullptr};
+    }
+};
+
+// A pool of workers for work that doesn't fit in a tick, such as pathfinding or procedural generation.
+// Every worker owns a deque and steals from the others once its own is empty; higher priority jobs are
+// always taken first. Jobs must not touch a registry, their results are applied by World::submit instead.
+class JobSystem {
+    std::vector<std::unique_ptr<detail::job_deque>> deques_;
+    std::vector<std::jthread> workers_;
+    std::atomic<std::size_t> next_{0};
+    std::atomic<std::size_t> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_;
+    bool stop_ = false;
+
+    static std::size_t& workerIndex() noexcept {
+        static thread_local std::size_t index = static_cast<std::size_t>(-1);
+        return index;
+    }
+
+    static JobSystem*& workerOwner() noexcept {
+        static thread_local JobSystem* owner = nullptr;
+        return owner;
+    }
+
+    // takes a job from `first`'s deque, or steals one from the others.
+    detail::job take(std::size_t const first) {
+        if (queued_.load(std::memory_order_acquire) == 0)
+            return {};
+        if (auto j = deques_[first]->pop()) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return j;
+        }
+        for (std::size_t i = 1; i < deques_.size(); ++i) {
+            if (auto j = deques_[(first + i) % deques_.size()]->steal()) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                return j;
+            }
+        }
+        return {};
+    }
+
+    void work(std::size_t const index) {
+        workerIndex() = index;
+        workerOwner() = this;
+        while (true) {
+            if (auto j = take(index)) {
+                j();
+                continue;
+            }
+            std::unique_lock lock{sleep_mutex_};
+            sleep_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+            if (stop_ && queued_.load(std::memory_order_acquire) == 0)
+                return;
+        }
+    }
+
+    void push(JobPriority const priority, detail::job j) {
+        // jobs submitted from a worker go to its own deque, the others are spread over all of them.
+        auto const index = workerOwner() == this
+            ? workerIndex()
+            : next_.fetch_add(1, std::memory_order_relaxed) % deques_.size();
+        deques_[index]->push(priority, std::move(j));
+        queued_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard const lock{sleep_mutex_};
+        }
+        sleep_.notify_one();
+    }
+
+public:
+    explicit JobSystem(std::size_t const threads = std::max(2u, std::thread::hardware_concurrency()) - 1) {
+        NOVA_ASSERT(threads > 0);
+        for (std::size_t i = 0; i < threads; ++i)
+            deques_.push_back(std::make_unique<detail::job_deque>());
+        for (std::size_t i = 0; i < threads; ++i)
+            workers_.emplace_back([this, i] { work(i); });
+    }
+
+    JobSystem(JobSystem const&) = delete;
+    JobSystem& operator=(JobSystem const&) = delete;
+
+    // queued jobs still run before the workers are joined.
+    ~JobSystem() {
+        {
+            std::lock_guard const lock{sleep_mutex_};
+            stop_ = true;
+        }
+        sleep_.notify_all();
+        workers_.clear();
+    }
+
+    // a process-wide job system for Worlds that aren't given one, it is never destroyed.
+    static JobSystem& shared() {
+        static auto* const jobs = new JobSystem();
+        return *jobs;
+    }
+
+    std::size_t numWorkers() const noexcept {
+        return workers_.size();
+    }
+
+    template<class F>
+    auto submit(F&& f, JobPriority const priority = JobPriority::Normal) {
+        using result_t = std::invoke_result_t<std::decay_t<F>&>;
+        auto state = std::make_shared<detail::job_state<result_t>>();
+        push(priority, detail::job{[state, f = std::forward<F>(f)]() mutable {
+            if constexpr (std::is_void_v<result_t>) {
+                f();
+                state->value.emplace();
+            }
+            else {
+                state->value.emplace(f());
+            }
+            state->ready.store(true, std::memory_order_release);
+        }});
+        return Future<result_t>{std::move(state)};
+    }
+
+    // runs one queued job on the calling thread, returns false if there was none.
+    bool runOne() {
+        auto const first = workerOwner() == this
+            ? workerIndex()
+            : next_.load(std::memory_order_relaxed) % deques_.size();
+        auto j = take(first);
+        if (j)
+            j();
+        return static_cast<bool>(j);
+    }
+
+    // Calls `f(i)` for every i in [0, n) on the calling thread and the workers and returns once all calls are done.
+    // The calling thread only waits on calls already running, never on unrelated jobs.
+    template<class F>
+    void parallelFor(std::size_t const n, F&& f) {
+        struct progress {
+            std::atomic<std::size_t> next{0};
+            std::atomic<std::size_t> done{0};
+        };
+        // helpers that start late find nothing left to do, so they may outlive this call.
+        auto const state = std::make_shared<progress>();
+        auto const run = [n, &f](progress& p) {
+            for (auto i = p.next.fetch_add(1, std::memory_order_relaxed); i < n; i = p.next.fetch_add(1, std::memory_order_relaxed)) {
+                f(i);
+                p.done.fetch_add(1, std::memory_order_release);
+            }
+        };
+
+        auto const helpers = std::min(n > 0 ? n - 1 : 0, workers_.size());
+        for (std::size_t i = 0; i < helpers; ++i)
+            push(JobPriority::High, detail::job{[state, run] { run(*state); }});
+        run(*state);
+        while (state->done.load(std::memory_order_acquire) < n)
+            std::this_thread::yield();
+    }
+
+    // blocks until `future` is ready, running queued jobs meanwhile.
+    template<class T>
+    void wait(Future<T> const& future) {
+        while (!future.ready()) {
+            if (!runOne())
+                std::this_thread::yield();
+        }
+    }
+};
+
+namespace detail {
+
+// a job whose result is applied to a registry on the thread that updates the World.
+struct pending_job {
+    std::uint64_t deadline;
+
+    explicit pending_job(std::uint64_t const tick) noexcept : deadline(tick) {}
+    virtual ~pending_job() = default;
+    virtual bool ready() const noexcept = 0;
+    virtual void wait(JobSystem& jobs) = 0;
+    virtual void apply(entt::registry& r) = 0;
+};
+
+template<class T, class A>
+struct applied_job final : pending_job {
+    Future<T> future;
+    A applier;
+
+    applied_job(std::uint64_t const tick, Future<T> f, A a)
+        : pending_job(tick), future(std::move(f)), applier(std::move(a)) {}
+
+    bool ready() const noexcept final {
+        return future.ready();
+    }
+
+    void wait(JobSystem& jobs) final {
+        jobs.wait(future);
+    }
+
+    void apply(entt::registry& r) final {
+        if constexpr (std::is_void_v<T>)
+            applier(r);
+        else
+            applier(r, future.get());
+    }
+};
+
+} // namespace detail
+
+} // namespace nova
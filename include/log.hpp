@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+// compile-time log level, calls below it expand to nothing so their arguments are never evaluated.
+#define NOVA_LOG_LEVEL_TRACE 0
+#define NOVA_LOG_LEVEL_DEBUG 1
+#define NOVA_LOG_LEVEL_INFO 2
+#define NOVA_LOG_LEVEL_WARN 3
+#define NOVA_LOG_LEVEL_ERROR 4
+#define NOVA_LOG_LEVEL_CRITICAL 5
+#define NOVA_LOG_LEVEL_OFF 6
+
+#ifndef NOVA_LOG_LEVEL
+    #define NOVA_LOG_LEVEL NOVA_LOG_LEVEL_INFO
+#endif
+
+namespace nova::log {
+
+struct Config {
+    std::string name = "nova";
+    // number of messages the queue holds, allocated once by `init`.
+    std::size_t queue_size = 8192;
+    std::size_t threads = 1;
+    // when the queue is full the oldest message is dropped, a logging call never waits on the backend.
+    spdlog::async_overflow_policy overflow = spdlog::async_overflow_policy::overrun_oldest;
+    std::vector<spdlog::sink_ptr> sinks = {std::make_shared<spdlog::sinks::stdout_color_sink_mt>()};
+};
+
+namespace detail {
+
+inline std::atomic<spdlog::logger*>& current() noexcept {
+    static std::atomic<spdlog::logger*> logger{nullptr};
+    return logger;
+}
+
+} // namespace detail
+
+// the engine logger, or spdlog's synchronous default logger while no Session is alive.
+inline spdlog::logger& get() noexcept {
+    if (auto* const logger = detail::current().load(std::memory_order_acquire); logger != nullptr)
+        return *logger;
+    return *spdlog::default_logger_raw();
+}
+
+// Owns the asynchronous engine logger, messages still queued are flushed when it goes out of scope.
+// Threads that log must be done before the session ends.
+class [[nodiscard]] Session {
+    std::shared_ptr<spdlog::async_logger> logger_;
+
+public:
+    explicit Session(Config const& config = {}) {
+        spdlog::init_thread_pool(config.queue_size, config.threads);
+        logger_ = std::make_shared<spdlog::async_logger>(config.name, config.sinks.begin(), config.sinks.end(),
+            spdlog::thread_pool(), config.overflow);
+        logger_->set_level(static_cast<spdlog::level::level_enum>(NOVA_LOG_LEVEL));
+        spdlog::register_logger(logger_);
+        detail::current().store(logger_.get(), std::memory_order_release);
+    }
+
+    Session(Session const&) = delete;
+    Session& operator=(Session const&) = delete;
+
+    ~Session() {
+        detail::current().store(nullptr, std::memory_order_release);
+        logger_->flush();
+        spdlog::drop(logger_->name());
+        logger_.reset();
+        // shutting down drops the default logger too, which `get` falls back on once the session is over.
+        auto fallback = spdlog::default_logger();
+        spdlog::shutdown();
+        spdlog::set_default_logger(std::move(fallback));
+    }
+};
+
+} // namespace nova::log
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_TRACE
+    #define NOVA_LOG_TRACE(...) ::nova::log::get().trace(__VA_ARGS__)
+#else
+    #define NOVA_LOG_TRACE(...) static_cast<void>(0)
+#endif
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_DEBUG
+    #define NOVA_LOG_DEBUG(...) ::nova::log::get().debug(__VA_ARGS__)
+#else
+    #define NOVA_LOG_DEBUG(...) static_cast<void>(0)
+#endif
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_INFO
+    #define NOVA_LOG_INFO(...) ::nova::log::get().info(__VA_ARGS__)
+#else
+    #define NOVA_LOG_INFO(...) static_cast<void>(0)
+#endif
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_WARN
+    #define NOVA_LOG_WARN(...) ::nova::log::get().warn(__VA_ARGS__)
+#else
+    #define NOVA_LOG_WARN(...) static_cast<void>(0)
+#endif
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_ERROR
+    #define NOVA_LOG_ERROR(...) ::nova::log::get().error(__VA_ARGS__)
+#else
+    #define NOVA_LOG_ERROR(...) static_cast<void>(0)
+#endif
+
+#if NOVA_LOG_LEVEL <= NOVA_LOG_LEVEL_CRITICAL
+    #define NOVA_LOG_CRITICAL(...) ::nova::log::get().critical(__VA_ARGS__)
+#else
+    #define NOVA_LOG_CRITICAL(...) static_cast<void>(0)
+#endif
\ No newline at end of file
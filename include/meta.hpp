@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 
 #include "../deps/entt/single_include/entt/entt.hpp"
@@ -31,6 +32,25 @@ struct sink_remove_reference<sink<Ts...>> {
 template<class Sink>
 using sink_remove_reference_t = typename sink_remove_reference<Sink>::type;
 
+template<class... Sinks>
+struct sink_cat;
+
+template<>
+struct sink_cat<> {
+    using type = sink<>;
+};
+
+template<class... Ts>
+struct sink_cat<sink<Ts...>> {
+    using type = sink<Ts...>;
+};
+
+template<class... Ts, class... Us, class... Rest>
+struct sink_cat<sink<Ts...>, sink<Us...>, Rest...> : sink_cat<sink<Ts..., Us...>, Rest...> {};
+
+template<class... Sinks>
+using sink_cat_t = typename sink_cat<Sinks...>::type;
+
 template<class...>
 struct always_false : std::false_type {};
 
@@ -79,6 +99,16 @@ struct is_in<Needle, Head, Tail...> {
 template<class Needle, class... Haystack>
 inline constexpr bool is_in_v = is_in<Needle, Haystack...>::value;
 
+// the position of the first occurrence of Needle, which must be in Haystack.
+template<class Needle, class Head, class... Tail>
+struct index_of : std::integral_constant<std::size_t, 1 + index_of<Needle, Tail...>::value> {};
+
+template<class Needle, class... Tail>
+struct index_of<Needle, Needle, Tail...> : std::integral_constant<std::size_t, 0> {};
+
+template<class Needle, class... Haystack>
+inline constexpr std::size_t index_of_v = index_of<Needle, Haystack...>::value;
+
 // concat a sink and a list of type into a sink of the unique types between them.
 template<class Out, class In, class... List>
 struct unique_concat_impl;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "component.hpp"
+#include "entity.hpp"
+
+namespace nova {
+
+// A set of components entities are spawned with in bulk, for projectiles, particles and the like. Spawning
+// reserves the entities and every pool once, then fills each pool in a single pass, instead of growing the
+// registry and each pool entity by entity:
+//   Prefab bullet{pos{}, vel{{}, 0.f, 10.f}};
+//   auto const spawned = bullet.spawn(reg, 1000, [](std::size_t i, pos& p, vel&) { p.x = 2.f * i; });
+template<class... Components>
+requires (sizeof...(Components) > 0) && std::conjunction_v<std::is_base_of<component_base, Components>...>
+class Prefab {
+    std::tuple<Components...> components_;
+    // per-entity components are built here before being moved into their pools, kept to reuse the memory.
+    // Spawning with per-entity values changes it, so those overloads aren't const.
+    std::tuple<std::vector<Components>...> staging_;
+
+    template<class C>
+    void insert(entt::registry& r, std::span<Entity const> const entities) const {
+        r.reserve<C>(r.size<C>() + entities.size());
+        r.insert<C>(entities.begin(), entities.end(), std::get<C>(components_));
+    }
+
+    template<class C>
+    void insertStaged(entt::registry& r, std::span<Entity const> const entities) {
+        auto& staged = std::get<std::vector<C>>(staging_);
+        r.reserve<C>(r.size<C>() + entities.size());
+        if constexpr (std::is_empty_v<C>)
+            r.insert<C>(entities.begin(), entities.end());
+        else
+            r.insert<C>(entities.begin(), entities.end(), std::make_move_iterator(staged.begin()), std::make_move_iterator(staged.end()));
+        staged.clear();
+    }
+
+    static void create(entt::registry& r, std::span<Entity> const out) {
+        r.reserve(r.size() + out.size());
+        r.create(out.begin(), out.end());
+    }
+
+public:
+    explicit Prefab(Components... components) : components_(std::move(components)...) {}
+
+    // the component entities are spawned with, changing it affects the next spawns.
+    template<class C>
+    C& get() noexcept {
+        return std::get<C>(components_);
+    }
+
+    template<class C>
+    C const& get() const noexcept {
+        return std::get<C>(components_);
+    }
+
+    // creates one entity per element of `out` with a copy of every component.
+    void spawn(entt::registry& r, std::span<Entity> const out) const {
+        create(r, out);
+        (insert<Components>(r, out), ...);
+    }
+
+    // Like `spawn`, then `init(i, components&...)` adjusts the components of the i-th entity before they are
+    // added, so per-entity values such as positions cost no lookups. `init` must not touch the registry.
+    template<class F>
+    requires std::is_invocable_v<F&, std::size_t, Components&...>
+    void spawn(entt::registry& r, std::span<Entity> const out, F&& init) {
+        (std::get<std::vector<Components>>(staging_).assign(out.size(), std::get<Components>(components_)), ...);
+        for (std::size_t i = 0; i < out.size(); ++i)
+            init(i, std::get<std::vector<Components>>(staging_)[i]...);
+        create(r, out);
+        (insertStaged<Components>(r, out), ...);
+    }
+
+    std::vector<Entity> spawn(entt::registry& r, std::size_t const n) const {
+        std::vector<Entity> entities(n);
+        spawn(r, entities);
+        return entities;
+    }
+
+    template<class F>
+    requires std::is_invocable_v<F&, std::size_t, Components&...>
+    std::vector<Entity> spawn(entt::registry& r, std::size_t const n, F&& init) {
+        std::vector<Entity> entities(n);
+        spawn(r, entities, std::forward<F>(init));
+        return entities;
+    }
+};
+
+} // namespace nova
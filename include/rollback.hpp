@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "delta.hpp"
+#include "util.hpp"
+#include "world.hpp"
+
+namespace nova {
+
+// Steps a World with a fixed time step while keeping the input, the delta and the undo delta of the last
+// `depth` ticks in a ring buffer, so the World can be rewound to any of them and simulated forward again.
+// Rewinding applies undo deltas, so its cost follows what changed during those ticks, not the size of the World.
+//
+// The input of a tick is set as the registry context variable `Input` before the World is updated.
+// Rewinding restores the entities and the ones created next, the pools of the listed components, and the
+// World's tick and time.
+// Everything else is outside rollback, so a tick must not depend on it:
+//   - other pools and context variables, including resources and event channels,
+//   - the order pools iterate in,
+//   - spawned tasks, jobs in flight and the coroutines of coroutine systems,
+//   - per-system state: the next run of systems with an interval RunRate, event reader cursors and where a
+//     deferred system resumes.
+template<class Input, class... Components>
+requires std::is_default_constructible_v<Input> && std::is_copy_assignable_v<Input>
+class Rollback {
+    struct Frame {
+        std::uint64_t tick = 0;
+        // the World's tick and time before the tick was simulated.
+        std::uint64_t world_tick = 0;
+        Time world_time{0};
+        Input input{};
+        std::vector<std::byte> delta;
+        std::vector<std::byte> undo;
+    };
+
+    World& world_;
+    Time step_;
+    DeltaRecorder<Components...> recorder_;
+    std::vector<Frame> frames_;
+    std::size_t size_ = 0;
+    std::uint64_t tick_ = 0;
+    std::vector<Input> replay_;
+
+    Frame& frameOf(std::uint64_t const tick) noexcept {
+        return frames_[tick % frames_.size()];
+    }
+
+    Frame const& frameOf(std::uint64_t const tick) const noexcept {
+        return frames_[tick % frames_.size()];
+    }
+
+public:
+    Rollback(World& world, Time const step, std::size_t const depth = 8)
+        : world_(world), step_(step), frames_(depth)
+    {
+        NOVA_ASSERT(depth > 0);
+        recorder_.reset(world_.registry());
+    }
+
+    // the tick the next call to `advance` simulates.
+    std::uint64_t tick() const noexcept {
+        return tick_;
+    }
+
+    // the oldest tick the World can be rewound to.
+    std::uint64_t oldestTick() const noexcept {
+        return tick_ - size_;
+    }
+
+    bool recorded(std::uint64_t const tick) const noexcept {
+        return tick >= oldestTick() && tick < tick_;
+    }
+
+    Input const& input(std::uint64_t const tick) const noexcept {
+        NOVA_ASSERT(recorded(tick));
+        return frameOf(tick).input;
+    }
+
+    // the delta produced by `tick`, to be replayed with DeltaRecorder<Components...>::apply.
+    std::span<std::byte const> delta(std::uint64_t const tick) const noexcept {
+        NOVA_ASSERT(recorded(tick));
+        return frameOf(tick).delta;
+    }
+
+    void advance(Input const& input) {
+        auto& frame = frameOf(tick_);
+        frame.tick = tick_;
+        frame.input = input;
+        // the buffers keep their capacity, recording a tick doesn't allocate once the ring is warm.
+        frame.delta.clear();
+        frame.undo.clear();
+
+        frame.world_tick = world_.scheduler().tick();
+        frame.world_time = world_.elapsed();
+
+        auto& r = world_.registry();
+        r.template ctx_or_set<Input>() = input;
+        world_.update(step_);
+        recorder_.record(r, tick_, frame.delta, &frame.undo);
+
+        ++tick_;
+        size_ = std::min(size_ + 1, frames_.size());
+    }
+
+    // restores the World to the state it had before `tick` was simulated, see above for what isn't restored.
+    bool rewind(std::uint64_t const tick) {
+        if (tick > tick_ || tick < oldestTick())
+            return false;
+        while (tick_ > tick) {
+            if (!recorder_.rewind(world_.registry(), frameOf(tick_ - 1).undo))
+                return false;
+            --tick_;
+            --size_;
+            world_.rewindClock(frameOf(tick_).world_tick, frameOf(tick_).world_time);
+        }
+        return true;
+    }
+
+    // replaces the input of `tick`, rewinds to it and simulates forward to the current tick again.
+    bool correct(std::uint64_t const tick, Input const& input) {
+        if (!recorded(tick))
+            return false;
+        replay_.clear();
+        replay_.push_back(input);
+        for (auto t = tick + 1; t < tick_; ++t)
+            replay_.push_back(frameOf(t).input);
+        if (!rewind(tick))
+            return false;
+        for (auto const& in : replay_)
+            advance(in);
+        return true;
+    }
+};
+
+} // namespace nova
\ No newline at end of file
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "system.hpp"
+#include "system_arena.hpp"
+#include "util.hpp"
+
+namespace nova::detail {
+
+// two systems can't run at the same time if one of them writes a component the other one touches.
+inline bool conflicts(SystemAccess const& a, SystemAccess const& b) noexcept {
+    auto const touches = [](SystemAccess const& access, entt::id_type const id) {
+        return std::find(access.reads.begin(), access.reads.end(), id) != access.reads.end()
+            || std::find(access.writes.begin(), access.writes.end(), id) != access.writes.end();
+    };
+    return std::any_of(a.writes.begin(), a.writes.end(), [&](auto const id) { return touches(b, id); })
+        || std::any_of(b.writes.begin(), b.writes.end(), [&](auto const id) { return touches(a, id); });
+}
+
+// Systems cheaper than this are packed with their neighbours into a single job, waking a worker costs more
+// than running them one after the other.
+inline constexpr std::chrono::nanoseconds pack_grain{50'000};
+
+// The systems of a stage in the order they run, cut into batches of systems that run in parallel and each
+// batch into chunks that run as one job. Once the arena is arranged in `order`, positions in `order` are also
+// positions in the arena.
+struct stage_schedule {
+    // indices into the stage's arena entries.
+    std::vector<std::uint32_t> order;
+    // where each batch ends in `order`.
+    std::vector<std::uint32_t> batches;
+    // where each chunk ends in `order`, batches end on a chunk boundary.
+    std::vector<std::uint32_t> chunks;
+    // the dependency graph, the positions the system at each position depends on within the stage.
+    std::vector<std::vector<std::uint32_t>> dependencies;
+    // how long each system takes, averaged over its recent runs. Zero until the system has run once.
+    std::vector<std::chrono::nanoseconds> costs;
+
+    // The longest chain of dependent systems weighted by their costs: the shortest the stage can take
+    // with unlimited workers. Positions are in topological order, so a single pass is enough.
+    std::chrono::nanoseconds criticalPath() const {
+        std::vector<std::chrono::nanoseconds> finish(order.size());
+        std::chrono::nanoseconds longest{0};
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            std::chrono::nanoseconds start{0};
+            for (auto const d : dependencies[k])
+                start = std::max(start, finish[d]);
+            finish[k] = start + costs[k];
+            longest = std::max(longest, finish[k]);
+        }
+        return longest;
+    }
+};
+
+// Orders the live systems of a stage so every system runs after its dependencies within the stage, and two
+// conflicting systems in the order they were added in unless their dependencies say otherwise, then puts each
+// system in the first batch after everything it depends on or conflicts with. Dependencies on systems of other
+// stages are left to the stage order.
+// The costs measured with the previous schedule, which `entries` are still arranged in, steer the order of the
+// systems that don't conflict: ready systems with the longest chain of work behind them go first, so they claim
+// the earlier batches and are started first within theirs, and cheap systems of a batch are packed into shared
+// chunks. Systems that haven't been measured yet get a chunk of their own. Costs never reorder conflicting
+// systems, so results don't depend on timing.
+inline void build_schedule(std::vector<system_arena::entry> const& entries, stage_schedule& out) {
+    std::vector<std::chrono::nanoseconds> cost(entries.size(), std::chrono::nanoseconds{0});
+    for (std::size_t i = 0; i < entries.size() && i < out.costs.size(); ++i)
+        cost[i] = out.costs[i];
+
+    out.order.clear();
+    out.batches.clear();
+    out.chunks.clear();
+    out.dependencies.clear();
+
+    std::unordered_map<SystemId, std::uint32_t> ids;
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].system != nullptr)
+            ids.emplace(entries[i].system->id(), i);
+    }
+
+    std::vector<std::vector<std::uint32_t>> dependents(entries.size());
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].system == nullptr)
+            continue;
+        for (auto const dep : entries[i].deps) {
+            if (auto const found = ids.find(dep); found != ids.end())
+                dependents[found->second].push_back(i);
+        }
+    }
+
+    // Kahn's algorithm, taking the ready system that comes first according to `before`.
+    auto const topological = [&](auto const before) {
+        std::vector<std::uint32_t> pending(entries.size(), 0);
+        for (std::uint32_t i = 0; i < entries.size(); ++i) {
+            for (auto const d : dependents[i])
+                ++pending[d];
+        }
+        auto const after = [&before](auto const a, auto const b) { return before(b, a); };
+        std::priority_queue<std::uint32_t, std::vector<std::uint32_t>, decltype(after)> ready{after};
+        for (std::uint32_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].system != nullptr && pending[i] == 0)
+                ready.push(i);
+        }
+        std::vector<std::uint32_t> order;
+        order.reserve(ids.size());
+        while (!ready.empty()) {
+            auto const i = ready.top();
+            ready.pop();
+            order.push_back(i);
+            for (auto const d : dependents[i]) {
+                if (--pending[d] == 0)
+                    ready.push(d);
+            }
+        }
+        NOVA_ASSERT(order.size() == ids.size() && "systems of a stage depend on each other in a cycle");
+        return order;
+    };
+
+    // Conflicting systems are chained in an order that only depends on when they were added: the order they come
+    // in when taken as added while respecting dependencies, so the extra edges can't close a cycle.
+    auto const added = topological([&entries](std::uint32_t const a, std::uint32_t const b) {
+        return entries[a].sequence < entries[b].sequence;
+    });
+    for (std::size_t k = 0; k < added.size(); ++k) {
+        for (std::size_t j = 0; j < k; ++j) {
+            if (conflicts(entries[added[j]].access, entries[added[k]].access))
+                dependents[added[j]].push_back(added[k]);
+        }
+    }
+
+    // the cost of a system plus the longest chain of systems waiting on it.
+    std::vector<std::chrono::nanoseconds> remaining(entries.size(), std::chrono::nanoseconds{0});
+    for (auto k = added.size(); k-- > 0;) {
+        auto const i = added[k];
+        for (auto const d : dependents[i])
+            remaining[i] = std::max(remaining[i], remaining[d]);
+        remaining[i] += cost[i];
+    }
+
+    auto const critical_first = [&remaining](std::uint32_t const a, std::uint32_t const b) {
+        return remaining[a] != remaining[b] ? remaining[a] > remaining[b] : a < b;
+    };
+    out.order = topological(critical_first);
+
+    std::vector<std::uint32_t> batch(entries.size(), 0);
+    for (std::size_t k = 0; k < out.order.size(); ++k) {
+        auto const i = out.order[k];
+        for (auto const dep : entries[i].deps) {
+            if (auto const found = ids.find(dep); found != ids.end())
+                batch[i] = std::max(batch[i], batch[found->second] + 1);
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            auto const other = out.order[j];
+            if (conflicts(entries[i].access, entries[other].access))
+                batch[i] = std::max(batch[i], batch[other] + 1);
+        }
+    }
+
+    std::sort(out.order.begin(), out.order.end(), [&](auto const a, auto const b) {
+        return batch[a] != batch[b] ? batch[a] < batch[b] : critical_first(a, b);
+    });
+
+    std::chrono::nanoseconds packed{0};
+    for (std::uint32_t k = 0; k < out.order.size(); ++k) {
+        auto const i = out.order[k];
+        auto const last = k + 1 == out.order.size() || batch[i] != batch[out.order[k + 1]];
+        packed += cost[i];
+        if (last || cost[i] == std::chrono::nanoseconds{0} || packed >= pack_grain
+            || cost[out.order[k + 1]] == std::chrono::nanoseconds{0}) {
+            out.chunks.push_back(k + 1);
+            packed = std::chrono::nanoseconds{0};
+        }
+        if (last)
+            out.batches.push_back(k + 1);
+    }
+
+    std::vector<std::uint32_t> position(entries.size(), 0);
+    for (std::uint32_t k = 0; k < out.order.size(); ++k)
+        position[out.order[k]] = k;
+    out.dependencies.resize(out.order.size());
+    out.costs.resize(out.order.size());
+    for (std::uint32_t k = 0; k < out.order.size(); ++k) {
+        for (auto const dep : entries[out.order[k]].deps) {
+            if (auto const found = ids.find(dep); found != ids.end())
+                out.dependencies[k].push_back(position[found->second]);
+        }
+        out.costs[k] = cost[out.order[k]];
+    }
+}
+
+} // namespace nova::detail
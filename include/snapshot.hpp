@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "component.hpp"
+#include "entity.hpp"
+#include "storage.hpp"
+#include "util.hpp"
+
+namespace nova {
+
+// Layout of a snapshot, all values are native-endian and every column starts on a snapshot_alignment boundary:
+//   snapshot_header
+//   entity column       (header.num_entities entities, including the destroyed ones so versions survive)
+//   num_pools times:
+//     pool_header
+//     entity column     (pool_header.size entities)
+//     component column  (pool_header.size raw components)
+namespace detail {
+
+inline constexpr std::uint32_t snapshot_magic = 0x41564f4e; // "NOVA"
+inline constexpr std::size_t snapshot_alignment = 64;
+
+struct snapshot_header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t num_entities;
+    std::uint32_t num_pools;
+    std::uint32_t entity_size;
+};
+
+struct pool_header {
+    entt::id_type type_id;
+    std::uint32_t component_size;
+    std::uint64_t size;
+};
+
+constexpr std::size_t align_snapshot(std::size_t const offset) noexcept {
+    return (offset + snapshot_alignment - 1) & ~(snapshot_alignment - 1);
+}
+
+class snapshot_writer {
+    std::vector<std::byte>& out_;
+
+public:
+    explicit snapshot_writer(std::vector<std::byte>& out) noexcept : out_(out) {}
+
+    // appends `size` bytes at the next aligned offset and returns the offset they start at.
+    // offsets stay valid while the buffer grows, pointers from `at` don't.
+    std::size_t column(std::size_t const size) {
+        auto const offset = align_snapshot(out_.size());
+        out_.resize(offset + size);
+        return offset;
+    }
+
+    std::byte* at(std::size_t const offset) noexcept {
+        return out_.data() + offset;
+    }
+
+    template<class T>
+    void value(T const& v) {
+        std::memcpy(at(column(sizeof(T))), &v, sizeof(T));
+    }
+};
+
+class snapshot_reader {
+    std::span<std::byte const> in_;
+    std::size_t offset_ = 0;
+
+public:
+    explicit snapshot_reader(std::span<std::byte const> in) noexcept : in_(in) {}
+
+    // returns nullptr if the snapshot is truncated.
+    std::byte const* column(std::size_t const size) noexcept {
+        auto const offset = align_snapshot(offset_);
+        if (offset > in_.size() || in_.size() - offset < size)
+            return nullptr;
+        offset_ = offset + size;
+        return in_.data() + offset;
+    }
+
+    // a column of `count` elements of `element_size` bytes, checked without multiplying so a corrupt count
+    // can't overflow.
+    std::byte const* column(std::uint64_t const count, std::size_t const element_size) noexcept {
+        auto const offset = align_snapshot(offset_);
+        if (offset > in_.size() || (element_size != 0 && count > (in_.size() - offset) / element_size))
+            return nullptr;
+        return column(static_cast<std::size_t>(count) * element_size);
+    }
+
+    template<class T>
+    bool value(T& v) noexcept {
+        auto const* const p = column(sizeof(T));
+        if (p != nullptr)
+            std::memcpy(&v, p, sizeof(T));
+        return p != nullptr;
+    }
+};
+
+// a read-only view of a whole file, memory mapped where the platform allows it.
+class mapped_file {
+    std::byte const* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector<std::byte> fallback_;
+
+public:
+    explicit mapped_file(std::filesystem::path const& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            if (void* const p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0); p != MAP_FAILED) {
+    #if defined(MADV_SEQUENTIAL)
+                ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+    #endif
+                data_ = static_cast<std::byte const*>(p);
+                size_ = st.st_size;
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return;
+        fallback_.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (file.read(reinterpret_cast<char*>(fallback_.data()), fallback_.size())) {
+            data_ = fallback_.data();
+            size_ = fallback_.size();
+        }
+#endif
+    }
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    ~mapped_file() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (data_ != nullptr)
+            ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+    }
+
+    explicit operator bool() const noexcept {
+        return data_ != nullptr;
+    }
+
+    std::span<std::byte const> bytes() const noexcept {
+        return {data_, size_};
+    }
+};
+
+} // namespace detail
+
+// Versioned binary snapshot of a registry's entities and the pools of the given components.
+// Components are written as raw columns, so they must be trivially copyable; pools of other types are not saved.
+template<class... Components>
+requires std::conjunction_v<std::is_base_of<component_base, Components>..., std::is_trivially_copyable<Components>...>
+class Snapshot {
+    template<class C>
+    static void writePool(entt::registry const& r, detail::snapshot_writer& w) {
+        auto const view = r.view<C const>();
+        auto const size = view.size();
+        w.value(detail::pool_header{entt::type_info<C>::id(), sizeof(C), size});
+        auto const entities_offset = w.column(size * sizeof(Entity));
+        auto const components_offset = w.column(size * sizeof(C));
+        auto* entities = w.at(entities_offset);
+        auto* components = w.at(components_offset);
+        if constexpr (is_paged_component_v<C> && !std::is_empty_v<C>) {
+            // paged pools aren't contiguous, copy them out in iteration order instead.
+            view.each([&entities, &components](auto const e, C const& c) {
+                std::memcpy(entities, &e, sizeof(Entity));
+                std::memcpy(components, &c, sizeof(C));
+                entities += sizeof(Entity);
+                components += sizeof(C);
+            });
+        }
+        else if (size > 0) {
+            std::memcpy(entities, view.data(), size * sizeof(Entity));
+            if constexpr (!std::is_empty_v<C>)
+                std::memcpy(components, view.raw(), size * sizeof(C));
+        }
+    }
+
+    template<class C>
+    static void readPool(entt::registry& r, detail::pool_header const& header, Entity const* entities, std::byte const* components) {
+        if constexpr (std::is_empty_v<C>) {
+            r.insert<C>(entities, entities + header.size);
+        }
+        else {
+            // columns are aligned, so the mapped bytes are used directly as the source of the bulk insert.
+            auto const* const first = reinterpret_cast<C const*>(components);
+            r.reserve<C>(header.size);
+            r.insert<C>(entities, entities + header.size, first, first + header.size);
+        }
+    }
+
+    template<class C>
+    static void copyPool(entt::registry const& from, entt::registry& to) {
+        auto const view = from.view<C const>();
+        auto const size = view.size();
+        if (size == 0)
+            return;
+        if constexpr (std::is_empty_v<C>) {
+            to.insert<C>(view.data(), view.data() + size);
+        }
+        else if constexpr (is_paged_component_v<C>) {
+            std::vector<Entity> entities;
+            std::vector<C> components;
+            entities.reserve(size);
+            components.reserve(size);
+            view.each([&entities, &components](auto const e, C const& c) {
+                entities.push_back(e);
+                components.push_back(c);
+            });
+            to.reserve<C>(size);
+            to.insert<C>(entities.begin(), entities.end(), components.begin(), components.end());
+        }
+        else {
+            to.reserve<C>(size);
+            to.insert<C>(view.data(), view.data() + size, view.raw(), view.raw() + size);
+        }
+    }
+
+public:
+    static constexpr std::uint32_t version = 1;
+
+    // Copies the entities and the given pools of `from` into `to` without going through bytes, contiguous pools
+    // are copied column by column and keep their order. `to` must have no entities.
+    static void copy(entt::registry const& from, entt::registry& to) {
+        NOVA_ASSERT(to.size() == 0);
+        to.assign(from.data(), from.data() + from.size());
+        (copyPool<Components>(from, to), ...);
+    }
+
+    static void write(entt::registry const& r, std::vector<std::byte>& out) {
+        detail::snapshot_writer w{out};
+        w.value(detail::snapshot_header{detail::snapshot_magic, version, r.size(), sizeof...(Components), sizeof(Entity)});
+        if (auto const offset = w.column(r.size() * sizeof(Entity)); r.size() > 0)
+            std::memcpy(w.at(offset), r.data(), r.size() * sizeof(Entity));
+        (writePool<Components>(r, w), ...);
+    }
+
+    // replaces the content of `r` with the snapshot, returns false if the snapshot is malformed or
+    // was written with a different version or component layout, in which case `r` is left as it was.
+    static bool read(entt::registry& r, std::span<std::byte const> in) {
+        detail::snapshot_reader reader{in};
+        detail::snapshot_header header{};
+        if (!reader.value(header) || header.magic != detail::snapshot_magic || header.version != version || header.entity_size != sizeof(Entity))
+            return false;
+
+        auto const* const entities = reinterpret_cast<Entity const*>(reader.column(header.num_entities, sizeof(Entity)));
+        if (entities == nullptr)
+            return false;
+
+        // every pool is checked before `r` is cleared.
+        struct pool_columns {
+            detail::pool_header header;
+            Entity const* entities;
+            std::byte const* components;
+        };
+        std::vector<pool_columns> pools;
+        pools.reserve(std::min<std::size_t>(header.num_pools, sizeof...(Components)));
+        for (std::uint32_t i = 0; i < header.num_pools; ++i) {
+            detail::pool_header pool{};
+            if (!reader.value(pool))
+                return false;
+            auto const* const pool_entities = reinterpret_cast<Entity const*>(reader.column(pool.size, sizeof(Entity)));
+            auto const* const components = reader.column(pool.size, pool.component_size);
+            if (pool_entities == nullptr || components == nullptr)
+                return false;
+
+            // pools of components this snapshot type doesn't know about are skipped.
+            if (((pool.type_id != entt::type_info<Components>::id()) && ...))
+                continue;
+            bool const fits = ((pool.type_id != entt::type_info<Components>::id() || pool.component_size == sizeof(Components)) && ...);
+            bool const alive = std::all_of(pool_entities, pool_entities + pool.size, [&header, entities](Entity const e) {
+                auto const pos = detail::entity_index(e);
+                return pos < header.num_entities && entities[pos] == e;
+            });
+            if (!fits || !alive)
+                return false;
+            pools.push_back({pool, pool_entities, components});
+        }
+
+        r.clear();
+        r.assign(entities, entities + header.num_entities);
+        for (auto const& pool : pools) {
+            ((pool.header.type_id == entt::type_info<Components>::id()
+                ? readPool<Components>(r, pool.header, pool.entities, pool.components) : void()), ...);
+        }
+        return true;
+    }
+
+    static bool save(entt::registry const& r, std::filesystem::path const& path) {
+        std::vector<std::byte> out;
+        write(r, out);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        return file && file.write(reinterpret_cast<char const*>(out.data()), out.size());
+    }
+
+    static bool load(entt::registry& r, std::filesystem::path const& path) {
+        detail::mapped_file const file{path};
+        return file && read(r, file.bytes());
+    }
+};
+
+} // namespace nova
\ No newline at end of file
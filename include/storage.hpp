@@ -0,0 +1,376 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "allocator.hpp"
+#include "component.hpp"
+
+// size in bytes of a single page of paged component storage.
+#ifndef NOVA_COMPONENT_PAGE_SIZE
+    #define NOVA_COMPONENT_PAGE_SIZE (std::size_t{64} << 10)
+#endif
+
+namespace nova::detail {
+
+template<class T>
+struct component_page_traits {
+    static constexpr std::size_t page_bytes = std::max(std::size_t{NOVA_COMPONENT_PAGE_SIZE}, std::bit_ceil(sizeof(T)));
+    // a power of two so an index splits into page and offset with a shift and a mask.
+    static constexpr std::size_t page_capacity = std::bit_floor(page_bytes / sizeof(T));
+    static constexpr std::size_t page_shift = std::countr_zero(page_capacity);
+    static constexpr std::size_t page_mask = page_capacity - 1;
+
+    static_assert(alignof(T) <= page_bytes);
+};
+
+} // namespace nova::detail
+
+namespace entt {
+
+// Storage for nova::paged_component_base types.
+// Components live in fixed-size pages drawn from a shared nova::PagePool. Growing the pool appends pages
+// instead of reallocating, so existing components are never copied or moved when entities are spawned.
+template<typename Entity, typename Type>
+class storage<Entity, Type, std::enable_if_t<nova::is_paged_component_v<Type> && !ENTT_IS_EMPTY(Type)>>: public sparse_set<Entity> {
+    static_assert(std::is_move_constructible_v<Type>);
+    static_assert(std::is_move_assignable_v<Type>);
+
+    using underlying_type = sparse_set<Entity>;
+    using traits_type = entt_traits<std::underlying_type_t<Entity>>;
+    using page_traits = nova::detail::component_page_traits<Type>;
+
+    template<bool Const>
+    class storage_iterator final {
+        friend class storage;
+
+        using instance_type = std::conditional_t<Const, const std::vector<Type *>, std::vector<Type *>>;
+        using index_type = typename traits_type::difference_type;
+
+        storage_iterator(instance_type &ref, const index_type idx) ENTT_NOEXCEPT
+            : pages{&ref}, index{idx}
+        {}
+
+    public:
+        using difference_type = index_type;
+        using value_type = Type;
+        using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+        using reference = std::conditional_t<Const, const value_type &, value_type &>;
+        using iterator_category = std::random_access_iterator_tag;
+
+        storage_iterator() ENTT_NOEXCEPT = default;
+
+        storage_iterator & operator++() ENTT_NOEXCEPT {
+            return --index, *this;
+        }
+
+        storage_iterator operator++(int) ENTT_NOEXCEPT {
+            storage_iterator orig = *this;
+            return operator++(), orig;
+        }
+
+        storage_iterator & operator--() ENTT_NOEXCEPT {
+            return ++index, *this;
+        }
+
+        storage_iterator operator--(int) ENTT_NOEXCEPT {
+            storage_iterator orig = *this;
+            return operator--(), orig;
+        }
+
+        storage_iterator & operator+=(const difference_type value) ENTT_NOEXCEPT {
+            index -= value;
+            return *this;
+        }
+
+        storage_iterator operator+(const difference_type value) const ENTT_NOEXCEPT {
+            storage_iterator copy = *this;
+            return (copy += value);
+        }
+
+        storage_iterator & operator-=(const difference_type value) ENTT_NOEXCEPT {
+            return (*this += -value);
+        }
+
+        storage_iterator operator-(const difference_type value) const ENTT_NOEXCEPT {
+            return (*this + -value);
+        }
+
+        difference_type operator-(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return other.index - index;
+        }
+
+        reference operator[](const difference_type value) const ENTT_NOEXCEPT {
+            const auto pos = size_type(index-value-1);
+            return (*pages)[pos >> page_traits::page_shift][pos & page_traits::page_mask];
+        }
+
+        bool operator==(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return other.index == index;
+        }
+
+        bool operator!=(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return !(*this == other);
+        }
+
+        bool operator<(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return index > other.index;
+        }
+
+        bool operator>(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return index < other.index;
+        }
+
+        bool operator<=(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return !(*this > other);
+        }
+
+        bool operator>=(const storage_iterator &other) const ENTT_NOEXCEPT {
+            return !(*this < other);
+        }
+
+        pointer operator->() const ENTT_NOEXCEPT {
+            const auto pos = size_type(index-1);
+            return (*pages)[pos >> page_traits::page_shift] + (pos & page_traits::page_mask);
+        }
+
+        reference operator*() const ENTT_NOEXCEPT {
+            return *operator->();
+        }
+
+    private:
+        instance_type *pages;
+        index_type index;
+    };
+
+    Type * slot(const std::size_t pos) const ENTT_NOEXCEPT {
+        return pages[pos >> page_traits::page_shift] + (pos & page_traits::page_mask);
+    }
+
+    void assure(const std::size_t cap) {
+        if(const auto required = (cap + page_traits::page_mask) >> page_traits::page_shift; required > pages.size()) {
+            auto &pool = nova::PagePool::shared(page_traits::page_bytes);
+            pool.reserve(required - pages.size());
+            pages.reserve(required);
+
+            while(pages.size() < required) {
+                pages.push_back(static_cast<Type *>(pool.allocate()));
+            }
+        }
+    }
+
+    void destroy_range(const std::size_t first, const std::size_t last) {
+        if constexpr(!std::is_trivially_destructible_v<Type>) {
+            for(auto pos = first; pos < last; ++pos) {
+                std::destroy_at(slot(pos));
+            }
+        }
+    }
+
+    void release_pages(const std::size_t keep) {
+        auto &pool = nova::PagePool::shared(page_traits::page_bytes);
+
+        while(pages.size() > keep) {
+            pool.deallocate(pages.back());
+            pages.pop_back();
+        }
+    }
+
+public:
+    using object_type = Type;
+    using entity_type = Entity;
+    using size_type = std::size_t;
+    using iterator = storage_iterator<false>;
+    using const_iterator = storage_iterator<true>;
+
+    static constexpr size_type page_capacity = page_traits::page_capacity;
+
+    storage() = default;
+
+    storage(storage &&other) ENTT_NOEXCEPT
+        : underlying_type{std::move(other)}, pages{std::move(other.pages)}
+    {}
+
+    storage & operator=(storage &&other) ENTT_NOEXCEPT {
+        if(this != &other) {
+            destroy_range(0u, underlying_type::size());
+            release_pages(0u);
+            underlying_type::operator=(std::move(other));
+            pages = std::move(other.pages);
+        }
+
+        return *this;
+    }
+
+    ~storage() override {
+        destroy_range(0u, underlying_type::size());
+        release_pages(0u);
+    }
+
+    void reserve(const size_type cap) {
+        underlying_type::reserve(cap);
+        assure(cap);
+    }
+
+    size_type capacity() const ENTT_NOEXCEPT {
+        return pages.size() * page_capacity;
+    }
+
+    void shrink_to_fit() {
+        underlying_type::shrink_to_fit();
+        release_pages((underlying_type::size() + page_traits::page_mask) >> page_traits::page_shift);
+        pages.shrink_to_fit();
+    }
+
+    // number of pages currently allocated, each holding up to page_capacity components.
+    size_type page_count() const ENTT_NOEXCEPT {
+        return pages.size();
+    }
+
+    const object_type * page(const size_type pos) const ENTT_NOEXCEPT {
+        return pages[pos];
+    }
+
+    object_type * page(const size_type pos) ENTT_NOEXCEPT {
+        return pages[pos];
+    }
+
+    const_iterator cbegin() const ENTT_NOEXCEPT {
+        const typename traits_type::difference_type pos = underlying_type::size();
+        return const_iterator{pages, pos};
+    }
+
+    const_iterator begin() const ENTT_NOEXCEPT {
+        return cbegin();
+    }
+
+    iterator begin() ENTT_NOEXCEPT {
+        const typename traits_type::difference_type pos = underlying_type::size();
+        return iterator{pages, pos};
+    }
+
+    const_iterator cend() const ENTT_NOEXCEPT {
+        return const_iterator{pages, {}};
+    }
+
+    const_iterator end() const ENTT_NOEXCEPT {
+        return cend();
+    }
+
+    iterator end() ENTT_NOEXCEPT {
+        return iterator{pages, {}};
+    }
+
+    const object_type & get(const entity_type entt) const {
+        return *slot(underlying_type::index(entt));
+    }
+
+    object_type & get(const entity_type entt) {
+        return const_cast<object_type &>(std::as_const(*this).get(entt));
+    }
+
+    const object_type * try_get(const entity_type entt) const {
+        return underlying_type::contains(entt) ? slot(underlying_type::index(entt)) : nullptr;
+    }
+
+    object_type * try_get(const entity_type entt) {
+        return const_cast<object_type *>(std::as_const(*this).try_get(entt));
+    }
+
+    template<typename... Args>
+    void emplace(const entity_type entt, Args &&... args) {
+        const auto pos = underlying_type::size();
+        assure(pos + 1u);
+
+        if constexpr(std::is_aggregate_v<object_type>) {
+            ::new (static_cast<void *>(slot(pos))) Type{std::forward<Args>(args)...};
+        } else {
+            ::new (static_cast<void *>(slot(pos))) Type(std::forward<Args>(args)...);
+        }
+
+        // entity goes after component in case constructor throws
+        underlying_type::emplace(entt);
+    }
+
+    template<typename It>
+    void insert(It first, It last, const object_type &value = {}) {
+        const auto from = underlying_type::size();
+        const auto to = from + std::distance(first, last);
+        assure(to);
+
+        for(auto pos = from; pos < to; ++pos) {
+            ::new (static_cast<void *>(slot(pos))) Type(value);
+        }
+
+        // entities go after components in case constructors throw
+        underlying_type::insert(first, last);
+    }
+
+    template<typename EIt, typename CIt>
+    void insert(EIt first, EIt last, CIt from, CIt to) {
+        auto pos = underlying_type::size();
+        assure(pos + std::distance(from, to));
+
+        for(; from != to; ++from, ++pos) {
+            ::new (static_cast<void *>(slot(pos))) Type(*from);
+        }
+
+        // entities go after components in case constructors throw
+        underlying_type::insert(first, last);
+    }
+
+    void erase(const entity_type entt) {
+        const auto last = underlying_type::size() - 1u;
+
+        if(const auto pos = underlying_type::index(entt); pos != last) {
+            *slot(pos) = std::move(*slot(last));
+        }
+
+        std::destroy_at(slot(last));
+        underlying_type::erase(entt);
+    }
+
+    void swap(const entity_type lhs, const entity_type rhs) override {
+        std::swap(*slot(underlying_type::index(lhs)), *slot(underlying_type::index(rhs)));
+        underlying_type::swap(lhs, rhs);
+    }
+
+    template<typename Compare, typename Sort = std_sort, typename... Args>
+    void sort(iterator first, iterator last, Compare compare, Sort algo = Sort{}, Args &&... args) {
+        ENTT_ASSERT(!(last < first));
+        ENTT_ASSERT(!(last > end()));
+
+        const auto from = underlying_type::begin() + std::distance(begin(), first);
+        const auto to = from + std::distance(first, last);
+
+        const auto apply = [this](const auto lhs, const auto rhs) {
+            std::swap(*slot(underlying_type::index(lhs)), *slot(underlying_type::index(rhs)));
+        };
+
+        if constexpr(std::is_invocable_v<Compare, const object_type &, const object_type &>) {
+            underlying_type::arrange(from, to, std::move(apply), [this, compare = std::move(compare)](const auto lhs, const auto rhs) {
+                return compare(std::as_const(*slot(underlying_type::index(lhs))), std::as_const(*slot(underlying_type::index(rhs))));
+            }, std::move(algo), std::forward<Args>(args)...);
+        } else {
+            underlying_type::arrange(from, to, std::move(apply), std::move(compare), std::move(algo), std::forward<Args>(args)...);
+        }
+    }
+
+    // pages are kept so refilling the storage doesn't go back to the pool.
+    void clear() {
+        destroy_range(0u, underlying_type::size());
+        underlying_type::clear();
+    }
+
+private:
+    std::vector<object_type *> pages;
+};
+
+} // namespace entt
\ No newline at end of file
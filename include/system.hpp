@@ -1,12 +1,23 @@
 #pragma once
 
+#include <chrono>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
+#include "commands.hpp"
 #include "component.hpp"
+#include "entity.hpp"
+#include "events.hpp"
 #include "meta.hpp"
+#include "storage.hpp"
+#include "task.hpp"
 #include "util.hpp"
 
 #include <iostream>
@@ -15,10 +26,63 @@ namespace nova {
 
 using SystemId = void(*)();
 
+// Systems run stage by stage, a stage only starts once every system of the previous one is done and the
+// commands they recorded are applied. A system picks its stage with `static constexpr Stage stage`.
+enum class Stage : std::uint8_t {
+    PreUpdate,
+    Update,
+    PostUpdate,
+    Render,
+};
+
+inline constexpr std::size_t num_stages = 4;
+
+// How often a system runs, picked with `static constexpr RunRate rate`, every tick by default. Expensive systems
+// that can wait, such as AI planning or LOD updates, run less often or on part of their entities each tick; the
+// World staggers systems sharing a rate so they don't all land on the same tick.
+struct RunRate {
+    // runs every `ticks` ticks, or when partitioned every tick on the entities whose index modulo `ticks` is the
+    // current slice, so each entity is processed once every `ticks` ticks.
+    std::uint32_t ticks = 1;
+    // runs once per `interval` of simulated time instead, when not zero.
+    Time interval{0};
+    bool partitioned = false;
+
+    static constexpr RunRate everyTicks(std::uint32_t const n) noexcept {
+        return {n};
+    }
+
+    static constexpr RunRate hertz(std::uint32_t const hz) noexcept {
+        return {1, std::chrono::duration_cast<Time>(std::chrono::seconds{1}) / hz};
+    }
+
+    static constexpr RunRate partitionedOver(std::uint32_t const n) noexcept {
+        return {n, Time{0}, true};
+    }
+
+    friend constexpr bool operator==(RunRate const&, RunRate const&) noexcept = default;
+};
+
+// the components a system reads and writes, used to tell which systems can run at the same time.
+struct SystemAccess {
+    std::span<entt::id_type const> reads;
+    std::span<entt::id_type const> writes;
+};
+
 struct ISystem {
     virtual void processImpl(entt::registry& r) const noexcept = 0;
     virtual void processImpl(entt::registry& r) noexcept = 0;
     virtual SystemId id() const noexcept = 0;
+    // resolves whatever the system looks up in `r` ahead of its first `processImpl`.
+    virtual void prepare(entt::registry&) noexcept {}
+    // applies the structural changes recorded during `processImpl`.
+    virtual void flush(entt::registry&) {}
+    // whether the system has nothing to do this tick and can be skipped, checked before it is dispatched.
+    virtual bool idle(entt::registry&) const noexcept { return false; }
+    // whether a deferrable system ran out of budget and continues where it stopped next tick.
+    virtual bool deferred() const noexcept { return false; }
+    // offsets a system with a RunRate, `ordinal` counts the systems of the World added before it with the same rate.
+    virtual void stagger(std::uint32_t /*ordinal*/, Time /*now*/) noexcept {}
     virtual ~ISystem() = default;
 };
 
@@ -38,6 +102,22 @@ template<class... Systems>
 requires std::conjunction_v<std::is_base_of<ISystem, Systems>...>
 struct Dependency {}; 
 
+// Global state such as time, input or a spatial index, kept in the registry context. Systems declaring the same
+// resources only as ReadRes run in parallel, and `process` gets them as `T const&` and `T&` respectively.
+template<class... Resources>
+struct ReadRes {};
+
+template<class... Resources>
+struct WriteRes {};
+
+// Typed channels systems send events on without structural changes, see events.hpp. A system sends with `send`
+// and reads what it hasn't seen yet with `receive`.
+template<class... Events>
+struct EventWriter {};
+
+template<class... Events>
+struct EventReader {};
+
 namespace detail {
 
 template<class>
@@ -63,11 +143,100 @@ struct strip_entity<meta::sink<E, Ts...>> {
 template<class T, class... Us>
 inline constexpr bool check_components_v = check_components<T, Us...>::value;
 
-template<class System, class View>
-concept process_view = requires(System&& s, View const& v) {
-    s.process(v);
+// `process` takes the view followed by the resources.
+template<class System, class View, class... Resources>
+concept process_view = requires(System&& s, View const& v, Resources&&... res) {
+    s.process(v, res...);
+};
+
+// `process` is a coroutine, the system keeps the task it returns and resumes it across ticks.
+template<class System, class View, class... Resources>
+concept process_task = requires(System&& s, View const& v, Resources&&... res) {
+    { s.process(v, res...) } -> std::same_as<Task>;
 };
 
+// resources get ids of their own, so a type used both as a component and a resource doesn't conflict with itself.
+template<class T>
+struct resource_tag {};
+
+template<class S>
+consteval bool runs_when_empty() noexcept {
+    if constexpr (requires { { &S::run_when_empty } -> std::same_as<bool const*>; })
+        return S::run_when_empty;
+    else
+        return false;
+}
+
+template<class S>
+consteval bool is_deferrable() noexcept {
+    if constexpr (requires { { &S::deferrable } -> std::same_as<bool const*>; })
+        return S::deferrable;
+    else
+        return false;
+}
+
+// The time the stages of the current tick should be done by, kept in the registry context and set by the World
+// from its tick budget. Deferrable systems stop iterating once it has passed.
+struct tick_deadline {
+    std::chrono::steady_clock::time_point at = std::chrono::steady_clock::time_point::max();
+};
+
+// entities a deferrable system processes between two looks at the clock, also the least it processes per tick
+// so it always makes progress.
+inline constexpr std::size_t deadline_check = 64;
+
+template<class S>
+consteval RunRate rate_of() noexcept {
+    if constexpr (requires { { &S::rate } -> std::same_as<RunRate const*>; })
+        return S::rate;
+    else
+        return {};
+}
+
+// whether a system with this rate is staggered by the World.
+constexpr bool staggered(RunRate const& rate) noexcept {
+    return rate.ticks > 1 || rate.interval > Time{0};
+}
+
+// The `ordinal`-th offset of a sequence spreading any number of offsets evenly over [0, interval): 0, 1/2, 1/4,
+// 3/4, 1/8... of the interval, the bits of the ordinal reversed.
+constexpr Time spread(std::uint32_t const ordinal, Time const interval) noexcept {
+    std::uint32_t reversed = 0;
+    for (std::uint32_t bit = 0; bit < 16; ++bit)
+        reversed |= (ordinal >> bit & 1) << (15 - bit);
+    return Time{interval.count() * reversed >> 16};
+}
+
+template<class S>
+consteval Stage stage_of() noexcept {
+    if constexpr (requires { { &S::stage } -> std::same_as<Stage const*>; })
+        return S::stage;
+    else
+        return Stage::Update;
+}
+
+template<class S>
+inline constexpr Stage stage_of_v = stage_of<S>();
+
+template<class Deps, class Target, class Seen>
+struct any_depends_on;
+
+// `Seen` holds the systems on the current path, so a cycle that doesn't involve `Target` still terminates.
+template<class... Ds, class Target, class... Seen>
+struct any_depends_on<meta::sink<Ds...>, Target, meta::sink<Seen...>> : std::disjunction<
+    std::disjunction<
+        std::is_same<Ds, Target>,
+        std::conjunction<
+            std::negation<meta::is_in<Ds, Seen...>>,
+            any_depends_on<typename Ds::dependencies, Target, meta::sink<Seen..., Ds>>>>...> {};
+
+// whether `S` depends on `Target`, directly or through its dependencies.
+template<class S, class Target>
+inline constexpr bool depends_on_v = any_depends_on<typename S::dependencies, Target, meta::sink<S>>::value;
+
+template<class... Systems>
+inline constexpr bool acyclic_v = (!depends_on_v<Systems, Systems> && ...);
+
 template<class T>
 struct InternalSystemId { 
     using id_type = void(*)();
@@ -76,22 +245,193 @@ struct InternalSystemId {
 
 } // namespace detail
 
-using SystemDependencyView = decltype(std::views::all(std::declval<std::array<SystemId, 1> const&>()));
+using SystemDependencyView = std::span<SystemId const>;
  
-template<class B, class R = Read<>, class W = Write<>, class E = Exclude<>, class D = Dependency<>>
+template<class B, class R = Read<>, class W = Write<>, class E = Exclude<>, class D = Dependency<>, class RR = ReadRes<>, class WR = WriteRes<>,
+    class EW = EventWriter<>, class ER = EventReader<>>
 struct SystemBase;
 
-template<class Base, class... Rs, class... Ws, class... Es, class... Ds>
-class SystemBase<Base, Read<Rs...>, Write<Ws...>, Exclude<Es...>, Dependency<Ds...>> : public ISystem {
+template<class Base, class... Rs, class... Ws, class... Es, class... Ds, class... RRs, class... WRs, class... EWs, class... ERs>
+class SystemBase<Base, Read<Rs...>, Write<Ws...>, Exclude<Es...>, Dependency<Ds...>, ReadRes<RRs...>, WriteRes<WRs...>,
+    EventWriter<EWs...>, EventReader<ERs...>> : public ISystem {
 public:
     using entities_view = decltype(std::declval<entt::registry>().view<std::add_const_t<Rs>..., Ws...>(entt::exclude<Es...>));
+    using read_components = meta::sink<Rs...>;
+    using write_components = meta::sink<Ws...>;
+    using dependencies = meta::sink<Ds...>;
+    using read_resources = meta::sink<RRs...>;
+    using write_resources = meta::sink<WRs...>;
     // TODO: using entities_group
 
 private:
     static constexpr detail::InternalSystemId<Base> id_{};
     static constexpr std::array<SystemId, sizeof...(Ds)> deps_ = {Ds::staticId()...};
+    // excluded components are read to filter the view.
+    static inline std::array<entt::id_type, sizeof...(Rs) + sizeof...(Es) + sizeof...(RRs)> const reads_ = {
+        entt::type_info<Rs>::id()..., entt::type_info<Es>::id()..., entt::type_info<detail::resource_tag<RRs>>::id()...};
+    static inline std::array<entt::id_type, sizeof...(Ws) + sizeof...(WRs)> const writes_ = {
+        entt::type_info<Ws>::id()..., entt::type_info<detail::resource_tag<WRs>>::id()...};
+
+    // resolved by `prepare`, context variables are stored on the heap so their addresses don't change.
+    mutable std::tuple<RRs const*..., WRs*...> resources_{};
+
+    // events sent during the stage, moved into their channels by `flush`.
+    mutable std::tuple<std::vector<EWs>...> outbox_;
+    std::tuple<Events<EWs>*...> writers_{};
+    std::tuple<Events<ERs> const*...> readers_{};
+    // the sequence number of the next event each reader hasn't seen.
+    mutable std::array<std::uint64_t, sizeof...(ERs)> cursors_{};
+
+    mutable Commands commands_;
+
+    // a view only holds pointers to its pools and a registry never destroys a pool, so the view stays valid
+    // for as long as the registry it was built from. It's rebuilt when the system runs on another registry.
+    mutable entt::registry const* view_registry_ = nullptr;
+    mutable std::optional<entities_view> view_;
+
+    // the running coroutine of a system whose `process` returns a Task.
+    mutable Task task_;
+
+    // set by `stagger`: the tick offset of a system running every few ticks, or the simulated time a system with
+    // an interval next runs at.
+    std::uint32_t phase_ = 0;
+    mutable Time next_{0};
+
+    // Deferrable systems, declaring `static constexpr bool deferrable = true`, stop once the tick is over budget
+    // and resume from this entity the next tick. If it was destroyed meanwhile the pass starts over.
+    mutable entt::entity resume_ = entt::null;
+    detail::tick_deadline const* deadline_ = nullptr;
+
+    template<class Self, class... MaybeEntity, class... Args>
+    void processDeferred(Self& self, entt::registry& r, [[maybe_unused]] std::uint32_t const part, meta::sink<MaybeEntity...>, meta::sink<Args...>) const noexcept {
+        auto const& view = cachedView(r);
+        auto it = view.begin();
+        if (resume_ != entt::null) {
+            if (auto const found = view.find(resume_); found != view.end())
+                it = found;
+            resume_ = entt::null;
+        }
+        auto const deadline = deadline_ != nullptr ? deadline_->at : std::chrono::steady_clock::time_point::max();
+        std::size_t n = 0;
+        for (auto const last = view.end(); it != last; ++it, ++n) {
+            auto const e = *it;
+            if (n != 0 && n % detail::deadline_check == 0 && deadline != std::chrono::steady_clock::time_point::max()
+                && std::chrono::steady_clock::now() > deadline) {
+                resume_ = e;
+                return;
+            }
+            if constexpr (detail::rate_of<Base>().partitioned) {
+                if (detail::entity_index(e) % detail::rate_of<Base>().ticks != part)
+                    continue;
+            }
+            if constexpr (sizeof...(MaybeEntity) > 0)
+                self.process(e, fetch<Args>(view, e)...);
+            else
+                self.process(fetch<Args>(view, e)...);
+        }
+    }
+
+    // the argument of `process` of type Arg for the entity `e` of the view, a resource or one of its components.
+    template<class Arg>
+    decltype(auto) fetch(entities_view const& view, entt::entity const e) const noexcept {
+        if constexpr (meta::is_in_v<std::remove_cvref_t<Arg>, RRs..., WRs...>)
+            return *std::get<std::remove_reference_t<Arg>*>(resources_);
+        else
+            return view.template get<std::remove_reference_t<Arg>>(e);
+    }
+
+    // whether the rate lets the system run this tick.
+    bool due(entt::registry& r) const noexcept {
+        constexpr auto rate = detail::rate_of<Base>();
+        auto const* const scheduler = r.try_ctx<Scheduler>();
+        if constexpr (rate.interval > Time{0})
+            return scheduler == nullptr || scheduler->now() >= next_;
+        else if constexpr (rate.ticks > 1 && !rate.partitioned)
+            return (scheduler == nullptr ? 0 : scheduler->tick() + phase_) % rate.ticks == 0;
+        else
+            return true;
+    }
+
+    // the entities of a partitioned system processed this tick are those whose index modulo `ticks` is the slice.
+    std::uint32_t slice(entt::registry& r) const noexcept {
+        auto const* const scheduler = r.try_ctx<Scheduler>();
+        return static_cast<std::uint32_t>((scheduler == nullptr ? 0 : scheduler->tick() + phase_) % detail::rate_of<Base>().ticks);
+    }
+
+    // moves the next run of a system with an interval past now, keeping its offset when runs were missed.
+    void advance(entt::registry& r) const noexcept {
+        constexpr auto rate = detail::rate_of<Base>();
+        if constexpr (rate.interval > Time{0}) {
+            if (auto const* const scheduler = r.try_ctx<Scheduler>(); scheduler != nullptr && scheduler->now() >= next_)
+                next_ += rate.interval * ((scheduler->now() - next_) / rate.interval + 1);
+        }
+    }
+
+    template<class F>
+    void stepTask(entt::registry& r, F&& start) const noexcept {
+        auto& scheduler = r.ctx_or_set<Scheduler>();
+        if (!task_.valid() || task_.done()) {
+            task_ = start();
+            scheduler.bind(task_);
+        }
+        scheduler.step(task_);
+    }
+
+    // the argument of `process` of type Arg, a resource or one of the components.
+    template<class Arg, class Components>
+    decltype(auto) inject(Components const& components) const noexcept {
+        if constexpr (meta::is_in_v<std::remove_cvref_t<Arg>, RRs..., WRs...>)
+            return *std::get<std::remove_reference_t<Arg>*>(resources_);
+        else
+            return std::get<std::remove_reference_t<Arg>&>(components);
+    }
+
+    entities_view const& cachedView(entt::registry& r) const noexcept {
+        if (view_registry_ != &r) {
+            view_.emplace(getView(r));
+            view_registry_ = &r;
+        }
+        return *view_;
+    }
+
+protected:
+    // records structural changes, they are applied once the system's stage is done.
+    Commands& commands() const noexcept {
+        return commands_;
+    }
+
+    template<class E>
+    void send(E event) const {
+        static_assert(meta::is_in_v<E, EWs...>, "the event must be declared in EventWriter<>");
+        std::get<std::vector<E>>(outbox_).push_back(std::move(event));
+    }
+
+    // the events of the channel sent since the last call, they stay valid until the end of the stage.
+    template<class E>
+    EventSpan<E> receive() const noexcept {
+        static_assert(meta::is_in_v<E, ERs...>, "the event must be declared in EventReader<>");
+        auto const* const channel = std::get<Events<E> const*>(readers_);
+        auto& cursor = cursors_[meta::index_of_v<E, ERs...>];
+        return channel->since(std::exchange(cursor, channel->end()));
+    }
 
 public:
+    SystemBase() = default;
+
+    // A copy starts out like a new system: no recorded commands, no cached view and no running task,
+    // coroutine frames can't be copied. It keeps the staggering of the original.
+    SystemBase(SystemBase const& other) noexcept : ISystem(), phase_(other.phase_), next_(other.next_) {}
+
+    SystemBase(SystemBase&&) noexcept = default;
+
+    SystemBase& operator=(SystemBase const& other) noexcept {
+        phase_ = other.phase_;
+        next_ = other.next_;
+        return *this;
+    }
+
+    SystemBase& operator=(SystemBase&&) noexcept = default;
+
     static constexpr SystemId staticId() noexcept {
         return id_.id;
     }
@@ -104,80 +444,186 @@ public:
         return sizeof...(Ds);
     }
 
-    static constexpr auto getDependencies() noexcept {
-        return std::views::all(deps_);
+    static constexpr SystemDependencyView getDependencies() noexcept {
+        return deps_;
+    }
+
+    static SystemAccess access() noexcept {
+        return {reads_, writes_};
     }
 
     static constexpr auto getView(entt::registry& r) noexcept {
         return r.view<std::add_const_t<Rs>..., Ws...>(entt::exclude<Es...>);
     }
 
+    // A system is skipped while one of the pools it reads or writes is empty, unless it declares
+    // `static constexpr bool run_when_empty = true`. Coroutines and event readers always run, skipping them
+    // would stall the coroutine or lose events.
     template<class B = Base>
-    requires (meta::has_process_mem_fn_v<B> && detail::process_view<B&, entities_view>)
+    static consteval bool skippable() noexcept {
+        return sizeof...(Rs) + sizeof...(Ws) > 0 && sizeof...(ERs) == 0 && !returnsTask<B>() && !detail::runs_when_empty<B>();
+    }
+
+    // whether `process` is a coroutine, such systems are kept at a stable address.
+    template<class B = Base>
+    static consteval bool returnsTask() noexcept {
+        return detail::process_task<B&, entities_view, RRs const&..., WRs&...>;
+    }
+
+    template<class B = Base>
+    requires (meta::has_process_mem_fn_v<B> && detail::process_view<B&, entities_view, RRs const&..., WRs&...>)
     constexpr void crtpProcess(entt::registry& r) noexcept {
-        static_cast<B&>(*this).process(getView(r));
+        static_assert(!detail::rate_of<B>().partitioned, "a partitioned system must take its components, not the view");
+        static_assert(!detail::is_deferrable<B>(), "a deferrable system must take its components, not the view");
+        auto const call = [this, &r] {
+            return std::apply([this, &r](auto*... res) { return static_cast<B&>(*this).process(cachedView(r), *res...); }, resources_);
+        };
+        if constexpr (returnsTask<B>())
+            stepTask(r, call);
+        else
+            call();
     }
 
     template<class B = Base>
-    requires (meta::has_process_mem_fn_v<B> && detail::process_view<B const&, entities_view>)
+    requires (meta::has_process_mem_fn_v<B> && detail::process_view<B const&, entities_view, RRs const&..., WRs&...>)
     constexpr void crtpProcess(entt::registry& r) const noexcept {
-        static_cast<B const&>(*this).process(getView(r));
+        static_assert(!detail::rate_of<B>().partitioned, "a partitioned system must take its components, not the view");
+        static_assert(!detail::is_deferrable<B>(), "a deferrable system must take its components, not the view");
+        auto const call = [this, &r] {
+            return std::apply([this, &r](auto*... res) { return static_cast<B const&>(*this).process(cachedView(r), *res...); }, resources_);
+        };
+        if constexpr (detail::process_task<B const&, entities_view, RRs const&..., WRs&...>)
+            stepTask(r, call);
+        else
+            call();
     }
 
-    template<class B = Base, class... MaybeEntity, class... Args, class... Ignore>
-    constexpr void crtpProcessComponents(entt::registry& r, meta::sink<MaybeEntity...>, meta::sink<Args...>, meta::sink<Ignore...>) noexcept {
-        r.view<std::remove_reference_t<Args>..., Ignore...>(entt::exclude<Es...>).each([this](MaybeEntity... e, Args... args, auto&&...) {
-            static_cast<B&>(*this).process(std::forward<decltype(e)>(e)..., std::forward<decltype(args)>(args)...);
-        });
+    // iterates the cached view and picks the components and resources `process` asks for by type.
+    template<class B = Base, class... MaybeEntity, class... Args>
+    constexpr void crtpProcessComponents(entt::registry& r, meta::sink<MaybeEntity...>, meta::sink<Args...>) noexcept {
+        [[maybe_unused]] auto const part = slice(r);
+        if constexpr (detail::is_deferrable<B>()) {
+            processDeferred(static_cast<B&>(*this), r, part, meta::sink<MaybeEntity...>{}, meta::sink<Args...>{});
+        }
+        else {
+            cachedView(r).each([this, part](typename entities_view::entity_type const e, auto&... components) -> void {
+                if constexpr (detail::rate_of<B>().partitioned) {
+                    if (detail::entity_index(e) % detail::rate_of<B>().ticks != part)
+                        return;
+                }
+                auto const all = std::forward_as_tuple(components...);
+                if constexpr (sizeof...(MaybeEntity) > 0)
+                    static_cast<B&>(*this).process(e, inject<Args>(all)...);
+                else
+                    static_cast<B&>(*this).process(inject<Args>(all)...);
+            });
+        }
     }
 
-    template<class B = Base, class... MaybeEntity, class... Args, class... Ignore>
-    constexpr void crtpProcessComponents(entt::registry& r, meta::sink<MaybeEntity...>, meta::sink<Args...>, meta::sink<Ignore...>) const noexcept {
-        r.view<std::remove_reference_t<Args>..., Ignore...>(entt::exclude<Es...>).each([this](MaybeEntity... e, Args... args, auto&&...) {
-            static_cast<B const&>(*this).process(std::forward<decltype(e)>(e)..., std::forward<decltype(args)>(args)...);
-        });
+    template<class B = Base, class... MaybeEntity, class... Args>
+    constexpr void crtpProcessComponents(entt::registry& r, meta::sink<MaybeEntity...>, meta::sink<Args...>) const noexcept {
+        [[maybe_unused]] auto const part = slice(r);
+        if constexpr (detail::is_deferrable<B>()) {
+            processDeferred(static_cast<B const&>(*this), r, part, meta::sink<MaybeEntity...>{}, meta::sink<Args...>{});
+        }
+        else {
+            cachedView(r).each([this, part](typename entities_view::entity_type const e, auto&... components) -> void {
+                if constexpr (detail::rate_of<B>().partitioned) {
+                    if (detail::entity_index(e) % detail::rate_of<B>().ticks != part)
+                        return;
+                }
+                auto const all = std::forward_as_tuple(components...);
+                if constexpr (sizeof...(MaybeEntity) > 0)
+                    static_cast<B const&>(*this).process(e, inject<Args>(all)...);
+                else
+                    static_cast<B const&>(*this).process(inject<Args>(all)...);
+            });
+        }
     }
 
     template<class B = Base>
-    requires (meta::has_process_mem_fn_v<B> && !detail::process_view<B&, entities_view>)
+    requires (meta::has_process_mem_fn_v<B> && !detail::process_view<B&, entities_view, RRs const&..., WRs&...>)
     constexpr void crtpProcess(entt::registry& r) noexcept {
         
         using process_args = typename meta::mem_fn_traits<decltype(&B::process)>::args_t;
         using entity_arg = typename detail::strip_entity<process_args>::entity_t;
         using view_args = typename detail::strip_entity<process_args>::args_t;
-        using ignore_args = meta::missing_types_t<meta::sink_remove_reference_t<view_args>, std::add_const_t<Rs>..., Ws...>;
 
-        static_assert(detail::check_components_v<view_args, std::add_const_t<Rs>..., Ws...>, 
-            "The components accessed within `process` must be present in the Read<> and Write<> template arguments. "
+        static_assert(detail::check_components_v<view_args, std::add_const_t<Rs>..., Ws..., std::add_const_t<RRs>..., WRs...>, 
+            "The components accessed within `process` must be present in the Read<> and Write<> template arguments, "
+            "and the resources in the ReadRes<> and WriteRes<> ones. "
             "Read<> reference arguments must be const-quailfied. Write<> reference arguments cannot be const-qualified. "
             "If the entity id is desired, it must be the first argument.");
 
-        crtpProcessComponents(r, entity_arg{}, view_args{}, ignore_args{});
+        crtpProcessComponents(r, entity_arg{}, view_args{});
     }
 
     template<class B = Base>
-    requires (meta::has_process_mem_fn_v<B> && !detail::process_view<B const&, entities_view>)
+    requires (meta::has_process_mem_fn_v<B> && !detail::process_view<B const&, entities_view, RRs const&..., WRs&...>)
     constexpr void crtpProcess(entt::registry& r) const noexcept {
         
         using process_args = typename meta::mem_fn_traits<decltype(&B::process)>::args_t;
         using entity_arg = typename detail::strip_entity<process_args>::entity_t;
         using view_args = typename detail::strip_entity<process_args>::args_t;
-        using ignore_args = meta::missing_types_t<meta::sink_remove_reference_t<view_args>, std::add_const_t<Rs>..., Ws...>;
 
-        static_assert(detail::check_components_v<view_args, std::add_const_t<Rs>..., Ws...>, 
-            "The components accessed within `process` must be present in the Read<> and Write<> template arguments. "
+        static_assert(detail::check_components_v<view_args, std::add_const_t<Rs>..., Ws..., std::add_const_t<RRs>..., WRs...>, 
+            "The components accessed within `process` must be present in the Read<> and Write<> template arguments, "
+            "and the resources in the ReadRes<> and WriteRes<> ones. "
             "Read<> reference arguments must be const-quailfied. Write<> reference arguments cannot be const-qualified. "
             "If the entity id is desired, it must be the first argument.");
 
-        crtpProcessComponents(r, entity_arg{}, view_args{}, ignore_args{});
+        crtpProcessComponents(r, entity_arg{}, view_args{});
+    }
+
+    void prepare(entt::registry& r) noexcept final {
+        static_assert(detail::rate_of<Base>().ticks > 0, "a system can't run every 0 ticks");
+        static_assert(!detail::rate_of<Base>().partitioned || detail::rate_of<Base>().interval == Time{0},
+            "a partitioned system runs every tick, it can't have an interval");
+        static_assert(std::conjunction_v<std::is_default_constructible<RRs>..., std::is_default_constructible<WRs>...>,
+            "resources missing from the registry context are default constructed when the system is added");
+        cachedView(r);
+        resources_ = {&r.ctx_or_set<RRs>()..., &r.ctx_or_set<WRs>()...};
+        if constexpr (detail::is_deferrable<Base>())
+            deadline_ = &r.ctx_or_set<detail::tick_deadline>();
+        writers_ = {&events<EWs>(r)...};
+        readers_ = {&events<ERs>(r)...};
+    }
+
+    bool deferred() const noexcept final {
+        return resume_ != entt::null;
+    }
+
+    // also idle on the ticks its rate skips.
+    bool idle(entt::registry& r) const noexcept final {
+        if (!due(r))
+            return true;
+        if constexpr (skippable())
+            return cachedView(r).size() == 0;
+        else
+            return false;
+    }
+
+    void flush(entt::registry& r) final {
+        commands_.apply(r);
+        (std::get<Events<EWs>*>(writers_)->append(std::get<std::vector<EWs>>(outbox_)), ...);
+    }
+
+    void stagger(std::uint32_t const ordinal, Time const now) noexcept final {
+        constexpr auto rate = detail::rate_of<Base>();
+        if constexpr (rate.interval > Time{0})
+            next_ = now + detail::spread(ordinal, rate.interval);
+        else
+            phase_ = ordinal % rate.ticks;
     }
 
     constexpr void processImpl(entt::registry& r) noexcept final {
         crtpProcess(r);
+        advance(r);
     }
 
     constexpr void processImpl(entt::registry& r) const noexcept final {
         crtpProcess(r);
+        advance(r);
     }
 };
 
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "system.hpp"
+#include "util.hpp"
+
+namespace nova::detail {
+
+inline constexpr std::size_t system_arena_alignment = 64;
+
+// type-erased operations on a system living in raw arena memory.
+struct system_ops {
+    std::size_t size;
+    std::size_t align;
+    ISystem* (*base)(void*) noexcept;
+    // the system object itself, which differs from the arena slot for boxed systems.
+    void* (*object)(void*) noexcept;
+    // move-constructs into `dst` and destroys `src`.
+    void (*relocate)(void* dst, void* src) noexcept;
+    // copy-constructs into `dst`, null for systems that can't be copied.
+    void (*copy)(void* dst, void const* src);
+    void (*destroy)(void*) noexcept;
+    // moves the system out of the arena onto the heap, the arena copy is left moved-from.
+    std::unique_ptr<ISystem> (*release)(void*);
+};
+
+template<class S>
+inline constexpr void (*copy_system)(void*, void const*) = nullptr;
+
+template<class S>
+requires std::is_copy_constructible_v<S>
+inline constexpr void (*copy_system<S>)(void*, void const*) = [](void* dst, void const* src) {
+    ::new (dst) S(*static_cast<S const*>(src));
+};
+
+template<class S>
+inline constexpr system_ops system_ops_of{
+    sizeof(S),
+    alignof(S),
+    [](void* p) noexcept -> ISystem* { return static_cast<S*>(p); },
+    [](void* p) noexcept -> void* { return p; },
+    [](void* dst, void* src) noexcept {
+        ::new (dst) S(std::move(*static_cast<S*>(src)));
+        static_cast<S*>(src)->~S();
+    },
+    copy_system<S>,
+    [](void* p) noexcept { static_cast<S*>(p)->~S(); },
+    [](void* p) -> std::unique_ptr<ISystem> { return std::make_unique<S>(std::move(*static_cast<S*>(p))); },
+};
+
+// Holds a system on the heap so its address never changes. Coroutine systems are stored boxed since their
+// suspended frames keep pointing at the system while the arena relocates what it stores.
+template<class S>
+class boxed_system final : public ISystem {
+    std::unique_ptr<S> system_;
+
+public:
+    explicit boxed_system(std::unique_ptr<S> system) noexcept : system_(std::move(system)) {}
+
+    void processImpl(entt::registry& r) const noexcept final {
+        std::as_const(*system_).processImpl(r);
+    }
+
+    void processImpl(entt::registry& r) noexcept final {
+        system_->processImpl(r);
+    }
+
+    SystemId id() const noexcept final {
+        return system_->id();
+    }
+
+    void prepare(entt::registry& r) noexcept final {
+        system_->prepare(r);
+    }
+
+    void flush(entt::registry& r) final {
+        system_->flush(r);
+    }
+
+    bool idle(entt::registry& r) const noexcept final {
+        return system_->idle(r);
+    }
+
+    void stagger(std::uint32_t const ordinal, Time const now) noexcept final {
+        system_->stagger(ordinal, now);
+    }
+
+    bool deferred() const noexcept final {
+        return system_->deferred();
+    }
+
+    S* get() noexcept {
+        return system_.get();
+    }
+
+    S const* get() const noexcept {
+        return system_.get();
+    }
+
+    std::unique_ptr<S> release() noexcept {
+        return std::move(system_);
+    }
+};
+
+// the copy gets a fresh box, its coroutine starts over the next time it runs.
+template<class S>
+requires std::is_copy_constructible_v<S>
+inline constexpr void (*copy_system<boxed_system<S>>)(void*, void const*) = [](void* dst, void const* src) {
+    ::new (dst) boxed_system<S>(std::make_unique<S>(*static_cast<boxed_system<S> const*>(src)->get()));
+};
+
+template<class S>
+inline constexpr system_ops system_ops_of<boxed_system<S>>{
+    sizeof(boxed_system<S>),
+    alignof(boxed_system<S>),
+    [](void* p) noexcept -> ISystem* { return static_cast<boxed_system<S>*>(p); },
+    [](void* p) noexcept -> void* { return static_cast<boxed_system<S>*>(p)->get(); },
+    [](void* dst, void* src) noexcept {
+        ::new (dst) boxed_system<S>(std::move(*static_cast<boxed_system<S>*>(src)));
+        static_cast<boxed_system<S>*>(src)->~boxed_system<S>();
+    },
+    copy_system<boxed_system<S>>,
+    [](void* p) noexcept { static_cast<boxed_system<S>*>(p)->~boxed_system<S>(); },
+    [](void* p) -> std::unique_ptr<ISystem> { return static_cast<boxed_system<S>*>(p)->release(); },
+};
+
+// Erasing leaves a hole that `arrange` closes, so removing many systems in a row costs one pass over the stage.
+class system_arena {
+public:
+    struct entry {
+        ISystem* system;
+        system_ops const* ops;
+        std::size_t offset;
+        SystemDependencyView deps;
+        SystemAccess access;
+        std::uint32_t slot;
+        // the order the system was added to the World in, which conflicting systems run in.
+        std::uint64_t sequence;
+    };
+
+private:
+    std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    std::vector<entry> entries_;
+    std::size_t dead_ = 0;
+
+    static std::byte* allocate(std::size_t const capacity) {
+        return static_cast<std::byte*>(::operator new(capacity, std::align_val_t{system_arena_alignment}));
+    }
+
+    static void deallocate(std::byte* const data) noexcept {
+        if (data != nullptr)
+            ::operator delete(data, std::align_val_t{system_arena_alignment});
+    }
+
+    // moves the live systems into a new buffer of `capacity` bytes, in order and without gaps.
+    void relayout(std::size_t const capacity) {
+        auto* const data = allocate(capacity);
+        std::size_t size = 0;
+        for (auto& e : entries_) {
+            if (e.system == nullptr)
+                continue;
+            size = (size + e.ops->align - 1) & ~(e.ops->align - 1);
+            e.ops->relocate(data + size, data_ + e.offset);
+            e.offset = size;
+            e.system = e.ops->base(data + size);
+            size += e.ops->size;
+        }
+        deallocate(data_);
+        data_ = data;
+        size_ = size;
+        capacity_ = capacity;
+    }
+
+    void destroy() noexcept {
+        for (auto const& e : entries_) {
+            if (e.system != nullptr)
+                e.ops->destroy(data_ + e.offset);
+        }
+        deallocate(data_);
+    }
+
+public:
+    system_arena() = default;
+
+    // copies every system to the same offset, holes included, so indices stay the same.
+    system_arena(system_arena const& other)
+        : data_(other.data_ == nullptr ? nullptr : allocate(other.capacity_)),
+          size_(other.size_),
+          capacity_(other.capacity_),
+          entries_(other.entries_),
+          dead_(other.dead_)
+    {
+        for (auto& e : entries_) {
+            if (e.system == nullptr)
+                continue;
+            NOVA_ASSERT(e.ops->copy != nullptr && "the system isn't copyable");
+            e.ops->copy(data_ + e.offset, other.data_ + e.offset);
+            e.system = e.ops->base(data_ + e.offset);
+        }
+    }
+
+    system_arena& operator=(system_arena const&) = delete;
+
+    system_arena(system_arena&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          entries_(std::move(other.entries_)),
+          dead_(std::exchange(other.dead_, 0))
+    {}
+
+    system_arena& operator=(system_arena&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, 0);
+            entries_ = std::move(other.entries_);
+            dead_ = std::exchange(other.dead_, 0);
+        }
+        return *this;
+    }
+
+    ~system_arena() {
+        destroy();
+    }
+
+    // constructs an S at the end of the batch and returns its index.
+    template<class S, class... Args>
+    std::uint32_t emplace(std::uint32_t const slot, std::uint64_t const sequence, SystemDependencyView const deps, SystemAccess const access,
+                          Args&&... args) {
+        static_assert(alignof(S) <= system_arena_alignment);
+        static_assert(std::is_nothrow_move_constructible_v<S>, "systems are relocated when their batch grows");
+
+        auto offset = (size_ + alignof(S) - 1) & ~(alignof(S) - 1);
+        if (offset + sizeof(S) > capacity_) {
+            relayout(std::max({capacity_ * 2, size_ + sizeof(S) + alignof(S), std::size_t{1024}}));
+            offset = (size_ + alignof(S) - 1) & ~(alignof(S) - 1);
+        }
+
+        auto* const system = ::new (data_ + offset) S(std::forward<Args>(args)...);
+        size_ = offset + sizeof(S);
+        entries_.push_back({system, &system_ops_of<S>, offset, deps, access, slot, sequence});
+        return static_cast<std::uint32_t>(entries_.size() - 1);
+    }
+
+    void* get(std::uint32_t const index) noexcept {
+        NOVA_ASSERT(entries_[index].system != nullptr);
+        return entries_[index].ops->object(data_ + entries_[index].offset);
+    }
+
+    // moves the system out of the arena and leaves a hole in its place.
+    std::unique_ptr<ISystem> release(std::uint32_t const index) {
+        auto& e = entries_[index];
+        auto ptr = e.ops->release(data_ + e.offset);
+        e.ops->destroy(data_ + e.offset);
+        e.system = nullptr;
+        ++dead_;
+        return ptr;
+    }
+
+    bool fragmented() const noexcept {
+        return dead_ > 0;
+    }
+
+    // puts the systems in the order given by the indices in `order`, which must name every live system once,
+    // and drops the holes left by `release`. `moved(slot, index)` is called for every system.
+    template<class F>
+    void arrange(std::span<std::uint32_t const> const order, F&& moved) {
+        NOVA_ASSERT(order.size() == size());
+        std::vector<entry> arranged;
+        arranged.reserve(order.size());
+        for (auto const index : order)
+            arranged.push_back(entries_[index]);
+        entries_ = std::move(arranged);
+        dead_ = 0;
+        relayout(std::max(capacity_, std::size_t{1024}));
+        for (std::uint32_t i = 0; i < entries_.size(); ++i)
+            moved(entries_[i].slot, i);
+    }
+
+    // the systems in dispatch order, holes are entries with a null system.
+    std::vector<entry> const& entries() const noexcept {
+        return entries_;
+    }
+
+    std::size_t size() const noexcept {
+        return entries_.size() - dead_;
+    }
+};
+
+} // namespace nova::detail
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../deps/entt/single_include/entt/entt.hpp"
+
+#include "component.hpp"
+#include "entity.hpp"
+#include "util.hpp"
+
+namespace nova {
+
+// empty components used as flags.
+template<class T>
+concept tag_component = std::is_empty_v<T> && std::is_base_of_v<component_base, T>;
+
+// One bit per entity index, set while the entity has the tag.
+class TagBits {
+    std::vector<std::uint64_t> words_;
+
+public:
+    static constexpr std::size_t word_bits = 64;
+
+    void set(std::size_t const index) {
+        if (index / word_bits >= words_.size())
+            words_.resize(index / word_bits + 1, 0);
+        words_[index / word_bits] |= std::uint64_t{1} << (index % word_bits);
+    }
+
+    void reset(std::size_t const index) noexcept {
+        if (index / word_bits < words_.size())
+            words_[index / word_bits] &= ~(std::uint64_t{1} << (index % word_bits));
+    }
+
+    bool test(std::size_t const index) const noexcept {
+        return index / word_bits < words_.size() && (words_[index / word_bits] >> (index % word_bits) & 1) != 0;
+    }
+
+    std::vector<std::uint64_t> const& words() const noexcept {
+        return words_;
+    }
+};
+
+namespace detail {
+
+// a distinct context variable per tag.
+template<class T>
+struct tag_bits : TagBits {};
+
+// the pool's signals are connected with the bitset as payload, so keeping it in sync costs no context lookup.
+template<class T>
+void set_tag(tag_bits<T>& bits, entt::registry&, Entity const e) {
+    bits.set(entity_index(e));
+}
+
+template<class T>
+void reset_tag(tag_bits<T>& bits, entt::registry&, Entity const e) {
+    bits.reset(entity_index(e));
+}
+
+// words filtered at once, small enough to stay on the stack and wide enough for the compiler to vectorize.
+inline constexpr std::size_t tag_block = 8;
+
+} // namespace detail
+
+// The bitset mirroring the pool of T. It is built from the pool the first time it is asked for and kept in sync
+// through the pool's signals afterwards.
+template<tag_component T>
+TagBits const& tagBits(entt::registry& r) {
+    if (auto const* const bits = r.try_ctx<detail::tag_bits<T>>())
+        return *bits;
+    auto& bits = r.set<detail::tag_bits<T>>();
+    for (auto const e : r.view<T>())
+        bits.set(detail::entity_index(e));
+    r.on_construct<T>().template connect<&detail::set_tag<T>>(bits);
+    r.on_destroy<T>().template connect<&detail::reset_tag<T>>(bits);
+    return bits;
+}
+
+// Calls `f(entity)` for every entity that has all of `Tags` and none of `Excluded`, in index order. The sets are
+// combined a block of words at a time with AND and ANDNOT, so filtering costs a few operations per 64 entities
+// instead of a sparse set lookup per entity and tag. `f` must not create entities.
+template<tag_component... Tags, tag_component... Excluded, class F>
+requires (sizeof...(Tags) > 0)
+void eachTagged(entt::registry& r, entt::exclude_t<Excluded...>, F&& f) {
+    std::array<std::vector<std::uint64_t> const*, sizeof...(Tags)> const in = {&tagBits<Tags>(r).words()...};
+    std::array<std::vector<std::uint64_t> const*, sizeof...(Excluded)> const out = {&tagBits<Excluded>(r).words()...};
+    std::size_t size = in[0]->size();
+    for (auto const* const words : in)
+        size = std::min(size, words->size());
+    auto const* const entities = r.data();
+
+    std::array<std::uint64_t, detail::tag_block> block;
+    for (std::size_t first = 0; first < size; first += detail::tag_block) {
+        auto const n = std::min(detail::tag_block, size - first);
+        for (std::size_t w = 0; w < n; ++w)
+            block[w] = (*in[0])[first + w];
+        for (std::size_t i = 1; i < in.size(); ++i) {
+            for (std::size_t w = 0; w < n; ++w)
+                block[w] &= (*in[i])[first + w];
+        }
+        for (auto const* const words : out) {
+            for (std::size_t w = 0; w < n && first + w < words->size(); ++w)
+                block[w] &= ~(*words)[first + w];
+        }
+        for (std::size_t w = 0; w < n; ++w) {
+            for (auto bits = block[w]; bits != 0; bits &= bits - 1)
+                f(entities[(first + w) * TagBits::word_bits + std::countr_zero(bits)]);
+        }
+    }
+}
+
+template<tag_component... Tags, class F>
+requires (sizeof...(Tags) > 0)
+void eachTagged(entt::registry& r, F&& f) {
+    eachTagged<Tags...>(r, entt::exclude<>, std::forward<F>(f));
+}
+
+// the number of entities that have all of `Tags` and none of `Excluded`.
+template<tag_component... Tags, tag_component... Excluded>
+std::size_t countTagged(entt::registry& r, entt::exclude_t<Excluded...> const exclude = {}) {
+    std::size_t count = 0;
+    eachTagged<Tags...>(r, exclude, [&count](Entity) { ++count; });
+    return count;
+}
+
+} // namespace nova
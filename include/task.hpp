@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "util.hpp"
+
+namespace nova {
+
+using Time = std::chrono::milliseconds;
+
+class Scheduler;
+
+// A coroutine that runs across ticks. It starts suspended and is resumed by the Scheduler it is bound to,
+// or by the system that returned it from `process`, once whatever it awaits has happened.
+class [[nodiscard]] Task {
+public:
+    struct promise_type {
+        Scheduler* scheduler = nullptr;
+        // the task is resumed once both the tick and the time are reached and the awaited job, if any, is done.
+        std::uint64_t wake_tick = 0;
+        Time wake_time{0};
+        std::atomic<bool> const* wait_for = nullptr;
+
+        Task get_return_object() noexcept {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+private:
+    friend class Scheduler;
+
+    handle_type handle_;
+
+    explicit Task(handle_type const handle) noexcept : handle_(handle) {}
+
+public:
+    Task() noexcept = default;
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool valid() const noexcept {
+        return static_cast<bool>(handle_);
+    }
+
+    bool done() const noexcept {
+        return handle_.done();
+    }
+};
+
+// Keeps the tick count and the time of a World and resumes the tasks spawned on it.
+// Spawned tasks run at the start of a tick, before any system.
+class Scheduler {
+    std::uint64_t tick_ = 0;
+    Time now_{0};
+    std::vector<Task> tasks_;
+
+public:
+    Scheduler() = default;
+
+    // starts counting from the given tick and time, with no tasks.
+    Scheduler(std::uint64_t const tick, Time const now) noexcept : tick_(tick), now_(now) {}
+
+    // the tick being simulated, or the next one between updates.
+    std::uint64_t tick() const noexcept {
+        return tick_;
+    }
+
+    Time now() const noexcept {
+        return now_;
+    }
+
+    std::size_t numTasks() const noexcept {
+        return tasks_.size();
+    }
+
+    // makes `task` resumable by this scheduler, it first runs the next time it is stepped.
+    void bind(Task& task) noexcept {
+        NOVA_ASSERT(task.valid());
+        auto& promise = task.handle_.promise();
+        promise.scheduler = this;
+        promise.wake_tick = tick_;
+        promise.wake_time = now_;
+    }
+
+    bool due(Task const& task) const noexcept {
+        auto const& promise = task.handle_.promise();
+        return tick_ >= promise.wake_tick && now_ >= promise.wake_time
+            && (promise.wait_for == nullptr || promise.wait_for->load(std::memory_order_acquire));
+    }
+
+    // resumes `task` if it is due and returns whether it has finished.
+    bool step(Task& task) {
+        if (due(task))
+            task.handle_.resume();
+        return task.done();
+    }
+
+    void spawn(Task task) {
+        bind(task);
+        tasks_.push_back(std::move(task));
+    }
+
+    // resumes every spawned task that is due, tasks spawned meanwhile run in the same pass.
+    void resume() {
+        for (std::size_t i = 0; i < tasks_.size();) {
+            if (!step(tasks_[i])) {
+                ++i;
+                continue;
+            }
+            if (i != tasks_.size() - 1)
+                tasks_[i] = std::move(tasks_.back());
+            tasks_.pop_back();
+        }
+    }
+
+    void advance(Time const now) noexcept {
+        ++tick_;
+        now_ = now;
+    }
+
+    // moves the tick and time back for a rewound World, spawned tasks keep their wake-up tick and time.
+    void rewind(std::uint64_t const tick, Time const now) noexcept {
+        tick_ = tick;
+        now_ = now;
+    }
+};
+
+// resumes the task on the next tick.
+struct NextTick {
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(Task::handle_type const handle) const noexcept {
+        auto& promise = handle.promise();
+        promise.wake_tick = promise.scheduler->tick() + 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+// resumes the task on the first tick at least `duration` after the current one.
+struct Delay {
+    Time duration;
+
+    bool await_ready() const noexcept {
+        return duration <= Time{0};
+    }
+
+    void await_suspend(Task::handle_type const handle) const noexcept {
+        auto& promise = handle.promise();
+        promise.wake_tick = promise.scheduler->tick() + 1;
+        promise.wake_time = promise.scheduler->now() + duration;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace nova
@@ -1,5 +1,28 @@
+// every header is included so a clash between two of them fails this translation unit.
+#include "allocator.hpp"
+#include "clock.hpp"
+#include "commands.hpp"
+#include "component.hpp"
+#include "delta.hpp"
+#include "entity.hpp"
+#include "events.hpp"
+#include "hierarchy.hpp"
+#include "jobs.hpp"
+#include "log.hpp"
+#include "meta.hpp"
+#include "prefab.hpp"
+#include "rollback.hpp"
+#include "schedule.hpp"
+#include "set_adapter.hpp"
+#include "snapshot.hpp"
+#include "storage.hpp"
 #include "system.hpp"
+#include "system_arena.hpp"
+#include "tags.hpp"
+#include "task.hpp"
+#include "util.hpp"
 #include "world.hpp"
+#include "world_host.hpp"
 
 #include <iostream>
 
@@ -0,0 +1,65 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x = 0.f; };
+struct count : component_base { int n = 0; };
+
+struct Slow : SystemBase<Slow, Read<pos>, Write<count>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<int>> {
+    static constexpr bool deferrable = true;
+
+    void process(Entity, count& c, int& total, pos const&) const noexcept {
+        ++c.n;
+        ++total;
+        std::this_thread::sleep_for(std::chrono::microseconds{20});
+    }
+};
+
+struct Fast : SystemBase<Fast, Read<>, Write<pos>> {
+    void process(pos& p) const noexcept {
+        p.x += 1.f;
+    }
+};
+
+// Over budget, a deferrable system resumes where it stopped on the next ticks, processing every entity once per
+// pass, while the other systems keep running every tick. Without a budget the pass fits in one tick.
+void deferral() {
+    JobSystem jobs{2};
+    World world{jobs};
+    auto& r = world.registry();
+    for (int i = 0; i < 1000; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e);
+        r.emplace<count>(e);
+    }
+    world.emplaceSystem<Slow>();
+    world.emplaceSystem<Fast>();
+    world.setTickBudget(std::chrono::milliseconds{2});
+
+    int ticks = 0;
+    do {
+        world.update(Time{16});
+        ++ticks;
+    } while (world.numDeferred() > 0);
+    assert(ticks > 1);
+    assert(world.resource<int>() == 1000);
+    for (auto const e : r.view<count>())
+        assert(r.get<count>(e).n == 1);
+    for (auto const e : r.view<pos>())
+        assert(r.get<pos>(e).x == static_cast<float>(ticks));
+
+    world.setTickBudget(std::chrono::nanoseconds{0});
+    world.update(Time{16});
+    assert(world.numDeferred() == 0);
+    for (auto const e : r.view<count>())
+        assert(r.get<count>(e).n == 2);
+}
+
+int main() {
+    deferral();
+}
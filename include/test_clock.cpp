@@ -0,0 +1,50 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+
+#include "clock.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+// 60 Hz isn't a whole number of milliseconds, a second of clock time still runs 60 ticks.
+void pacingDoesNotDrift() {
+    World world;
+    ManualClock clock;
+    runFixed(world, clock, std::chrono::nanoseconds{std::chrono::seconds{1}} / 60, [&clock] { return clock.now() >= Time{1000}; });
+    assert(world.scheduler().tick() == 60);
+}
+
+// the time updates simulate keeps up with the clock, whether the period is longer or shorter than its rounding.
+void simulatedTimeTracksClock() {
+    for (std::uint32_t const hz : {60u, 600u, 700u, 1000u}) {
+        World world;
+        ManualClock clock;
+        runFixed(world, clock, std::chrono::nanoseconds{std::chrono::seconds{1}} / hz, [&clock] {
+            return clock.now() >= Time{10'000};
+        });
+        assert(world.scheduler().tick() == 10 * hz);
+        assert(world.elapsed() == clock.now());
+    }
+}
+
+// an update taking longer than the period is caught up, at most `max_catch_up` ticks at once.
+void lateTicksAreCaughtUp() {
+    World world;
+    ManualClock clock;
+    std::uint64_t rounds = 0;
+    runFixed(world, clock, std::chrono::milliseconds{10}, [&] {
+        if (rounds++ == 1)
+            clock.advance(Time{100});
+        return clock.now() >= Time{200};
+    }, 3);
+    // 20 ticks without the stall, 3 of the 10 ticks it swallows are caught up and the other 7 dropped.
+    assert(world.scheduler().tick() == 13);
+}
+
+int main() {
+    pacingDoesNotDrift();
+    simulatedTimeTracksClock();
+    lateTicksAreCaughtUp();
+}
@@ -0,0 +1,66 @@
+#undef NDEBUG
+#include <cassert>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+struct paged : paged_component_base { int value; };
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>> {
+    mutable int runs = 0;
+
+    void process(entities_view const& view) const noexcept {
+        ++runs;
+        for (auto const e : view)
+            view.get<pos>(e).x += view.get<vel const>(e).dx;
+    }
+};
+
+struct Idle : SystemBase<Idle, Read<pos>> {
+    Task process(entities_view const&) const {
+        for (;;)
+            co_await NextTick{};
+    }
+};
+
+// A clone starts with the entities, listed pools, systems and clock of the original, then both simulate apart.
+void clonesSimulateApart() {
+    World world;
+    auto& r = world.registry();
+    for (int i = 0; i < 100; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e, pos{{}, 0.f});
+        r.emplace<vel>(e, vel{{}, 1.f});
+        if (i % 3 == 0)
+            r.emplace<paged>(e, paged{{}, i});
+    }
+    r.destroy(Entity{5});
+    world.emplaceSystem<Move>();
+    world.emplaceSystem<Idle>();
+    for (int t = 0; t < 10; ++t)
+        world.update(Time{1});
+
+    auto clone = world.clone<pos, vel, paged>();
+    auto& c = clone.registry();
+    assert(clone.id() != world.id());
+    assert(c.size() == r.size() && !c.valid(Entity{5}));
+    assert(clone.scheduler().tick() == 10 && clone.getSystem<Move>().runs == 10);
+    assert(c.size<paged>() == r.size<paged>());
+    for (auto const e : r.view<paged>())
+        assert(c.get<paged>(e).value == r.get<paged>(e).value);
+
+    for (int t = 0; t < 5; ++t)
+        clone.update(Time{1});
+    for (auto const e : c.view<pos>())
+        assert(c.get<pos>(e).x == 15.f && r.get<pos>(e).x == 10.f);
+
+    world.update(Time{1});
+    assert(world.getSystem<Move>().runs == 11 && clone.getSystem<Move>().runs == 15);
+}
+
+int main() {
+    clonesSimulateApart();
+}
@@ -0,0 +1,82 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+
+// loads over several ticks: waits a tick, moves everything, then waits 50ms of simulated time.
+struct Loader : SystemBase<Loader, Read<>, Write<pos>> {
+    mutable int step = 0;
+    mutable int starts = 0;
+
+    Task process(entities_view view) const noexcept {
+        ++starts;
+        step = 1;
+        co_await NextTick{};
+        for (auto const e : view)
+            view.get<pos>(e).x += 1.f;
+        step = 2;
+        co_await Delay{Time{50}};
+        step = 3;
+    }
+};
+
+// A coroutine system resumes where it left off on the tick it waits for, and starts over the tick after it
+// finishes.
+void systemsSpanTicks() {
+    World world;
+    auto& r = world.registry();
+    auto const e = r.create();
+    r.emplace<pos>(e, pos{{}, 0.f});
+    world.addSystem(std::make_unique<Loader>());
+    auto const& loader = world.getSystem<Loader>();
+
+    world.update(Time{10});
+    assert(loader.step == 1);
+    world.update(Time{10});
+    assert(loader.step == 2 && r.get<pos>(e).x == 1.f);
+    for (int t = 0; t < 4; ++t) {
+        world.update(Time{10});
+        assert(loader.step == 2);
+    }
+    world.update(Time{10});
+    assert(loader.step == 3 && loader.starts == 1);
+    world.update(Time{10});
+    assert(loader.step == 1 && loader.starts == 2);
+
+    // a removed system hands back its state, the suspended coroutine is dropped.
+    world.update(Time{10});
+    auto const removed = world.removeSystem<Loader>();
+    assert(removed->step == 2);
+}
+
+Task record(World& world, std::vector<std::uint64_t>& ticks) {
+    ticks.push_back(world.scheduler().tick());
+    co_await NextTick{};
+    ticks.push_back(world.scheduler().tick());
+    co_await Delay{Time{25}};
+    ticks.push_back(world.scheduler().tick());
+}
+
+// spawned tasks are resumed at the start of the ticks they wait for and dropped once done.
+void spawnedTasks() {
+    World world;
+    std::vector<std::uint64_t> ticks;
+    world.spawn(record(world, ticks));
+    for (int t = 0; t < 6; ++t)
+        world.update(Time{10});
+    // ticks are 10ms apart, so the 25ms delay from the tick at 10ms ends on the tick at 40ms.
+    assert((ticks == std::vector<std::uint64_t>{0, 1, 4}));
+    assert(world.scheduler().numTasks() == 0);
+}
+
+int main() {
+    systemsSpanTicks();
+    spawnedTasks();
+}
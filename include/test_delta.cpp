@@ -0,0 +1,208 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "delta.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : paged_component_base { float x, y; int pad[4]; };
+struct vel : component_base { float dx, dy; };
+struct tag : component_base {};
+
+struct A : SystemBase<A, Read<vel>, Write<pos>> {
+    void process(pos&, vel const&) const noexcept {}
+};
+
+struct B : SystemBase<B, Read<pos>, Write<vel, pos>> {
+    void process(vel&) const noexcept {}
+};
+
+// a component several systems write is recorded once.
+static_assert(std::is_same_v<SystemsDeltaRecorder<A, B>, DeltaRecorder<pos, vel>>);
+
+using Recorder = DeltaRecorder<pos, vel, tag>;
+
+// whether both registries have the same entities, with the same bytes in every recorded pool.
+bool same(entt::registry const& a, entt::registry const& b) {
+    if (a.alive() != b.alive() || a.size<pos>() != b.size<pos>() || a.size<vel>() != b.size<vel>() || a.size<tag>() != b.size<tag>())
+        return false;
+    bool equal = true;
+    a.each([&](auto const e) {
+        equal = equal && b.valid(e);
+    });
+    a.view<pos const>().each([&](auto const e, pos const& p) {
+        equal = equal && b.has<pos>(e) && std::memcmp(&b.get<pos>(e), &p, sizeof(pos)) == 0;
+    });
+    a.view<vel const>().each([&](auto const e, vel const& v) {
+        equal = equal && b.has<vel>(e) && std::memcmp(&b.get<vel>(e), &v, sizeof(vel)) == 0;
+    });
+    for (auto const e : a.view<tag const>())
+        equal = equal && b.has<tag>(e);
+    return equal;
+}
+
+// the alive entities and the bytes of every component in slot order, and the entities created next.
+struct State {
+    std::vector<Entity> entities;
+    std::vector<Entity> next;
+    std::vector<std::byte> components;
+
+    friend bool operator==(State const&, State const&) = default;
+};
+
+// Hands out the destroyed entities to see their order and puts them back as they were. Destroyed slots at the end
+// of the list, which are handed out just like new slots, count as not being there.
+State capture(entt::registry& r) {
+    State s;
+    while (r.alive() != r.size())
+        s.next.push_back(r.create());
+    for (auto it = s.next.rbegin(); it != s.next.rend(); ++it)
+        r.destroy(*it, detail::entity_version(*it));
+    auto size = r.size();
+    while (!s.next.empty() && s.next.back() == detail::entity_at(size - 1, 0)) {
+        s.next.pop_back();
+        --size;
+    }
+    auto const append = [&s](void const* p, std::size_t const size) {
+        auto const offset = s.components.size();
+        s.components.resize(offset + size);
+        std::memcpy(s.components.data() + offset, p, size);
+    };
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        auto const e = r.data()[i];
+        if (!detail::is_alive_at(e, i))
+            continue;
+        s.entities.push_back(e);
+        if (auto const* const p = r.try_get<pos>(e))
+            append(p, sizeof(pos));
+        if (auto const* const v = r.try_get<vel>(e))
+            append(v, sizeof(vel));
+        s.components.push_back(std::byte{r.has<tag>(e)});
+    }
+    return s;
+}
+
+void mutate(entt::registry& r, std::vector<Entity>& alive, std::mt19937& rng) {
+    for (int k = 0; k < 20; ++k) {
+        auto const op = rng() % 6;
+        if (op == 0 || alive.empty()) {
+            auto const e = alive.emplace_back(r.create());
+            if (rng() % 2 == 0)
+                r.emplace<pos>(e, pos{{}, 1.f, 2.f, {}});
+            continue;
+        }
+        auto const i = rng() % alive.size();
+        auto const e = alive[i];
+        if (op == 1) {
+            r.destroy(e);
+            alive.erase(alive.begin() + i);
+        }
+        else if (op == 2) {
+            r.emplace_or_replace<vel>(e, vel{{}, static_cast<float>(rng() % 10), 0.f});
+        }
+        else if (op == 3) {
+            if (r.has<pos>(e))
+                r.get<pos>(e).y += 1.f;
+        }
+        else if (op == 4) {
+            if (r.has<tag>(e))
+                r.remove<tag>(e);
+            else
+                r.emplace<tag>(e);
+        }
+        else {
+            r.remove_if_exists<vel>(e);
+        }
+    }
+}
+
+// applying every recorded delta to another registry replays the same ticks.
+void replay() {
+    entt::registry source;
+    entt::registry replica;
+    Recorder recorder;
+    recorder.reset(source);
+    std::mt19937 rng{1};
+    std::vector<Entity> alive;
+
+    for (std::uint64_t tick = 1; tick < 200; ++tick) {
+        mutate(source, alive, rng);
+        std::vector<std::byte> delta;
+        recorder.record(source, tick, delta);
+        assert(Recorder::apply(replica, delta));
+        assert(same(source, replica) && same(replica, source));
+    }
+}
+
+// rewinding the undo deltas newest first goes back through every recorded state, the entities created next included.
+void undo() {
+    entt::registry r;
+    Recorder recorder;
+    recorder.reset(r);
+    std::mt19937 rng{2};
+    std::vector<Entity> alive;
+
+    std::vector<State> states(50);
+    std::vector<std::vector<std::byte>> undos(states.size());
+    for (std::size_t tick = 0; tick < states.size(); ++tick) {
+        states[tick] = capture(r);
+        mutate(r, alive, rng);
+        std::vector<std::byte> delta;
+        recorder.record(r, tick, delta, &undos[tick]);
+    }
+
+    for (auto tick = states.size(); tick-- > 0;) {
+        assert(recorder.rewind(r, undos[tick]));
+        assert(capture(r) == states[tick]);
+    }
+}
+
+// Creating an entity with a hint past the end of the entity list appends slots while destroyed entities are
+// left, rewinding still hands out the same entities afterwards.
+void undoHint() {
+    entt::registry r;
+    std::vector<Entity> entities(6);
+    r.create(entities.begin(), entities.end());
+    r.destroy(entities[1]);
+    r.destroy(entities[4]);
+    r.emplace<pos>(entities[2], pos{{}, 1.f, 2.f, {}});
+    Recorder recorder;
+    recorder.reset(r);
+    auto const before = capture(r);
+
+    r.destroy(entities[2]);
+    r.create(detail::entity_at(9, 3));
+    std::vector<std::byte> delta;
+    std::vector<std::byte> undo;
+    recorder.record(r, 1, delta, &undo);
+
+    assert(recorder.rewind(r, undo));
+    assert(capture(r) == before);
+    assert(r.get<pos>(entities[2]).y == 2.f);
+}
+
+// a delta for another set of components is rejected.
+void schemaMismatch() {
+    entt::registry r;
+    Recorder recorder;
+    recorder.reset(r);
+    r.emplace<vel>(r.create());
+    std::vector<std::byte> delta;
+    recorder.record(r, 1, delta);
+
+    entt::registry other;
+    assert(!DeltaRecorder<vel>::apply(other, delta));
+}
+
+int main() {
+    replay();
+    undo();
+    undoHint();
+    schemaMismatch();
+}
@@ -0,0 +1,54 @@
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+
+// the order systems ran in during the last update.
+inline std::atomic<int> next{0};
+
+template<class Self, class... Deps>
+struct Timed : SystemBase<Self, Read<pos>, Write<>, Exclude<>, Dependency<Deps...>> {
+    mutable int ran = -1;
+
+    void process(typename Timed::entities_view const&) const noexcept {
+        ran = next++;
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }
+};
+
+struct A : Timed<A> {};
+struct B : Timed<B, A> {};
+struct C : Timed<C, B> {};
+struct D : Timed<D> {};
+
+static_assert(detail::depends_on_v<C, A>);
+static_assert(!detail::depends_on_v<A, C>);
+static_assert(detail::acyclic_v<A, B, C, D>);
+
+// Systems run after everything they depend on, directly or not, whatever order they were added in, and the
+// critical path follows the longest chain.
+void transitiveOrder() {
+    JobSystem jobs{4};
+    World world{jobs};
+    world.registry().emplace<pos>(world.registry().create());
+    world.addSystems<C, D, B, A>();
+
+    for (int t = 0; t < 3; ++t) {
+        next = 0;
+        world.update(Time{1});
+        assert(world.getSystem<A>().ran < world.getSystem<B>().ran);
+        assert(world.getSystem<B>().ran < world.getSystem<C>().ran);
+    }
+    assert(world.criticalPath() >= std::chrono::milliseconds{6});
+}
+
+int main() {
+    transitiveOrder();
+}
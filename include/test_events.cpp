@@ -0,0 +1,104 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "events.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct Hit { Entity target; int damage; };
+
+// the values of the events in `span`, oldest first.
+std::vector<int> damages(EventSpan<Hit> const& span) {
+    std::vector<int> out;
+    span.each([&out](Hit const& hit) { out.push_back(hit.damage); });
+    return out;
+}
+
+// A cursor sees every event once, across the swap at the end of a tick, and events older than the previous tick
+// are gone.
+void cursors() {
+    Events<Hit> channel;
+    std::uint64_t cursor = 0;
+    channel.push(Hit{entt::null, 1});
+    channel.push(Hit{entt::null, 2});
+    assert(damages(channel.since(cursor)) == (std::vector{1, 2}));
+    cursor = channel.end();
+
+    channel.swap();
+    std::vector batch = {Hit{entt::null, 3}};
+    channel.append(batch);
+    assert(batch.empty());
+    assert(damages(channel.since(cursor)) == (std::vector{3}));
+    assert(damages(channel.since(0)) == (std::vector{1, 2, 3}));
+
+    channel.swap();
+    channel.swap();
+    assert(channel.since(0).empty());
+    assert(channel.end() == 3);
+}
+
+struct Early : SystemBase<Early, Read<pos>, Write<>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<>, EventWriter<>,
+    EventReader<Hit>> {
+    static constexpr Stage stage = Stage::PreUpdate;
+    mutable int seen = 0;
+
+    void process(entities_view const&) const noexcept {
+        receive<Hit>().each([this](Hit const& hit) { seen += hit.damage; });
+    }
+};
+
+struct Shoot : SystemBase<Shoot, Read<pos>, Write<>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<>, EventWriter<Hit>> {
+    void process(Entity const e, pos const&) const noexcept {
+        send(Hit{e, 1});
+    }
+};
+
+struct ShootHarder : SystemBase<ShootHarder, Read<pos>, Write<>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<>,
+    EventWriter<Hit>> {
+    void process(Entity const e, pos const&) const noexcept {
+        send(Hit{e, 10});
+    }
+};
+
+struct Late : SystemBase<Late, Read<pos>, Write<>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<>, EventWriter<>,
+    EventReader<Hit>> {
+    static constexpr Stage stage = Stage::PostUpdate;
+    mutable int seen = 0;
+
+    void process(entities_view const&) const noexcept {
+        receive<Hit>().each([this](Hit const& hit) { seen += hit.damage; });
+    }
+};
+
+// Readers before the writers' stage see a tick's events on the next tick, readers after it on the same tick, and
+// both see each event exactly once.
+void readersSeeEachEventOnce() {
+    JobSystem jobs{3};
+    World world{jobs};
+    auto& r = world.registry();
+    for (int i = 0; i < 5; ++i)
+        r.emplace<pos>(r.create());
+    world.emplaceSystem<Early>();
+    world.emplaceSystem<Shoot>();
+    world.emplaceSystem<ShootHarder>();
+    world.emplaceSystem<Late>();
+
+    for (int t = 0; t < 4; ++t)
+        world.update(Time{1});
+    assert(world.getSystem<Late>().seen == 4 * 55);
+    assert(world.getSystem<Early>().seen == 3 * 55);
+
+    world.send(Hit{entt::null, 1000});
+    world.update(Time{1});
+    assert(world.getSystem<Early>().seen == 4 * 55 + 1000);
+    assert(world.getSystem<Late>().seen == 5 * 55 + 1000);
+}
+
+int main() {
+    cursors();
+    readersSeeEachEventOnce();
+}
@@ -0,0 +1,43 @@
+#undef NDEBUG
+#include <cassert>
+
+#include "entity.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+// A handle only resolves in the World it was made for, and a packed entity stops resolving once its entity is
+// destroyed, also after the slot is reused.
+void generations() {
+    World world;
+    World other;
+    auto& r = world.registry();
+
+    auto const e = r.create();
+    auto const handle = world.handle(e);
+    assert(handle && world.valid(handle) && !other.valid(handle));
+
+    PackedEntity const packed{e};
+    assert(world.valid(packed) && world.entity(packed) == e);
+    assert(packed.index() == entt::to_integral(e));
+
+    r.destroy(e);
+    assert(!world.valid(handle) && !world.valid(packed));
+    assert(world.entity(packed) == entt::null);
+
+    auto const reused = r.create();
+    assert(!world.valid(handle) && !world.valid(packed));
+    PackedEntity const repacked{reused};
+    assert(world.valid(repacked) && world.entity(repacked) == reused);
+}
+
+void nulls() {
+    World world;
+    assert(!PackedEntity{} && !world.valid(PackedEntity{}));
+    assert(!Handle{});
+}
+
+int main() {
+    generations();
+    nulls();
+}
@@ -0,0 +1,72 @@
+#undef NDEBUG
+#include <cassert>
+#include <random>
+#include <vector>
+
+#include "hierarchy.hpp"
+
+using namespace nova;
+
+struct transform : component_base { int local; int world; };
+
+// the world value of `e` found by walking up to its root.
+int expected(entt::registry& r, Entity e) {
+    int sum = 0;
+    for (; e != entt::null; e = r.get<Relationship>(e).parent)
+        sum += r.get<transform>(e).local;
+    return sum;
+}
+
+// Propagating visits parents before their children, also after nodes are destroyed, detached and attached
+// elsewhere between passes.
+void propagatesParentsFirst() {
+    entt::registry r;
+    std::mt19937 rng{1};
+    std::vector<Entity> entities;
+    for (int i = 0; i < 2000; ++i) {
+        auto const e = entities.emplace_back(r.create());
+        r.emplace<transform>(e, transform{{}, i, 0});
+        if (i > 0 && rng() % 10 != 0)
+            attach(r, e, entities[rng() % i]);
+        else
+            r.emplace<Relationship>(e);
+    }
+
+    for (int round = 0; round < 3; ++round) {
+        for (auto const e : r.view<transform>()) {
+            auto& t = r.get<transform>(e);
+            if (!r.has<Relationship>(e) || r.get<Relationship>(e).parent == entt::null)
+                t.world = t.local;
+        }
+        propagate<transform>(r, [](transform const& parent, transform& child) { child.world = parent.world + child.local; });
+        for (auto const e : entities) {
+            if (r.valid(e))
+                assert(r.get<transform>(e).world == expected(r, e));
+        }
+
+        r.destroy(entities[5 + round]);
+        r.emplace<transform>(r.create(), transform{});
+        detach(r, entities[100 + round]);
+        attach(r, entities[300 + round], entities[200 + round]);
+    }
+}
+
+// destroying a node detaches it from its parent and makes its children roots.
+void destroyOrphansChildren() {
+    entt::registry r;
+    auto const root = r.create();
+    auto const middle = r.create();
+    auto const leaf = r.create();
+    r.emplace<Relationship>(root);
+    attach(r, middle, root);
+    attach(r, leaf, middle);
+
+    r.destroy(middle);
+    assert(r.get<Relationship>(leaf).parent == entt::null);
+    assert(r.get<Relationship>(root).first_child == entt::null);
+}
+
+int main() {
+    propagatesParentsFirst();
+    destroyOrphansChildren();
+}
@@ -0,0 +1,81 @@
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "jobs.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+
+// every job runs once, whatever its priority.
+void runsEveryJob() {
+    JobSystem jobs{3};
+    std::atomic<int> count{0};
+    std::vector<Future<void>> futures;
+    for (int i = 0; i < 1000; ++i)
+        futures.push_back(jobs.submit([&count] { ++count; }, JobPriority(i % 3)));
+    for (auto const& future : futures)
+        jobs.wait(future);
+    assert(count == 1000);
+
+    std::vector<std::atomic<int>> calls(500);
+    jobs.parallelFor(calls.size(), [&calls](std::size_t const i) { ++calls[i]; });
+    for (auto const& c : calls)
+        assert(c == 1);
+}
+
+// A job with a deadline is applied on that tick at the latest, one without is applied on the first tick after
+// it finished. Results are applied on the thread updating the World.
+void appliesResults() {
+    JobSystem jobs{3};
+    World world{jobs};
+    auto& r = world.registry();
+    auto const e = r.create();
+    r.emplace<pos>(e, pos{{}, 0.f});
+    auto const updater = std::this_thread::get_id();
+
+    world.submit([] { return 7.f; }, [e, updater](entt::registry& reg, float const x) {
+        assert(std::this_thread::get_id() == updater);
+        reg.get<pos>(e).x = x;
+    }, JobPriority::High, 0);
+    bool applied = false;
+    world.submit([] { std::this_thread::sleep_for(std::chrono::milliseconds{20}); }, [&applied](entt::registry&) { applied = true; });
+
+    world.update(Time{10});
+    assert(r.get<pos>(e).x == 7.f);
+    for (int t = 0; t < 100 && !applied; ++t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        world.update(Time{10});
+    }
+    assert(applied);
+}
+
+Task await(World& world, int& out) {
+    out = co_await world.jobs().submit([] { return 42; });
+    co_await world.jobs().submit([] {});
+    out += 1;
+}
+
+// a task awaiting a future is resumed on a tick after the job finished.
+void tasksAwaitFutures() {
+    JobSystem jobs{3};
+    World world{jobs};
+    int out = 0;
+    world.spawn(await(world, out));
+    for (int t = 0; t < 100 && out != 43; ++t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        world.update(Time{10});
+    }
+    assert(out == 43);
+}
+
+int main() {
+    runsEveryJob();
+    appliesResults();
+    tasksAwaitFutures();
+}
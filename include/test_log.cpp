@@ -0,0 +1,44 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/ringbuffer_sink.h>
+
+#include "log.hpp"
+
+int evaluated = 0;
+
+int sideEffect() {
+    return ++evaluated;
+}
+
+// Messages logged from several threads during a session all reach the sinks by the time it ends, and calls
+// below the compile-time level don't evaluate their arguments.
+void session() {
+    auto const sink = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(1000);
+    {
+        nova::log::Config config;
+        config.sinks = {sink};
+        config.overflow = spdlog::async_overflow_policy::block;
+        nova::log::Session const session{config};
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([t] {
+                for (int i = 0; i < 100; ++i)
+                    NOVA_LOG_INFO("thread {} message {}", t, i);
+            });
+        }
+        threads.clear();
+        NOVA_LOG_DEBUG("never {}", sideEffect());
+        NOVA_LOG_INFO("done {}", sideEffect());
+    }
+    assert(sink->last_raw().size() == 401);
+    assert(evaluated == 1);
+    assert(&nova::log::get() == spdlog::default_logger_raw());
+}
+
+int main() {
+    session();
+}
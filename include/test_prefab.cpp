@@ -0,0 +1,74 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "prefab.hpp"
+#include "tags.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x = 0.f; float y = 0.f; };
+struct vel : paged_component_base { float dx = 0.f; float dy = 0.f; };
+struct bullet : component_base {};
+
+// spawning with per-entity values changes the prefab's staging buffers, so a const prefab can't do it.
+static_assert(!requires(Prefab<pos> const& p, entt::registry& r) { p.spawn(r, 1, [](std::size_t, pos&) {}); });
+static_assert(requires(Prefab<pos> const& p, entt::registry& r) { p.spawn(r, 1); });
+
+// every entity gets a copy of each component, in the pools of regular, paged and empty components alike.
+void spawnCopies() {
+    entt::registry r;
+    r.destroy(r.create());
+    Prefab const prefab{pos{}, vel{{}, 1.f, 2.f}, bullet{}};
+
+    auto const spawned = prefab.spawn(r, 1000);
+    assert(spawned.size() == 1000);
+    assert(r.size<pos>() == 1000 && r.size<vel>() == 1000 && r.size<bullet>() == 1000);
+    for (auto const e : spawned) {
+        assert(r.valid(e));
+        assert(r.get<vel>(e).dy == 2.f);
+        assert(r.has<bullet>(e));
+    }
+    // the destroyed slot is reused first, like with create().
+    assert(detail::entity_index(spawned.front()) == 0);
+}
+
+// `init` sees the i-th entity's components before they are added, later spawns start from the prefab again.
+void spawnWithInit() {
+    entt::registry r;
+    Prefab prefab{pos{}, vel{{}, 1.f, 0.f}, bullet{}};
+
+    auto const first = prefab.spawn(r, 5000, [](std::size_t const i, pos& p, vel& v, bullet&) {
+        p.x = static_cast<float>(i);
+        v.dx = -1.f;
+    });
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        assert(r.get<pos>(first[i]).x == static_cast<float>(i));
+        assert(r.get<vel>(first[i]).dx == -1.f);
+    }
+
+    auto const second = prefab.spawn(r, 3, [](std::size_t, pos& p, vel&, bullet&) { p.y = 7.f; });
+    for (auto const e : second) {
+        assert(r.get<pos>(e).y == 7.f);
+        assert(r.get<vel>(e).dx == 1.f);
+    }
+    assert(countTagged<bullet>(r) == first.size() + second.size());
+}
+
+// changing the prefab's components affects the next spawns only.
+void editPrefab() {
+    entt::registry r;
+    Prefab prefab{pos{}};
+    auto const before = prefab.spawn(r, 2);
+    prefab.get<pos>().x = 3.f;
+    auto const after = prefab.spawn(r, 2);
+    assert(r.get<pos>(before[0]).x == 0.f);
+    assert(r.get<pos>(after[1]).x == 3.f);
+}
+
+int main() {
+    spawnCopies();
+    spawnWithInit();
+    editPrefab();
+}
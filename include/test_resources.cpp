@@ -0,0 +1,75 @@
+#undef NDEBUG
+#include <cassert>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+
+struct Step { float dt = 0.5f; };
+struct Stats { int moved = 0; };
+struct Input { int key = 0; };
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>, Exclude<>, Dependency<>, ReadRes<Step>> {
+    void process(pos& p, Step const& step, vel const& v) const noexcept {
+        p.x += v.dx * step.dt;
+    }
+};
+
+struct Count : SystemBase<Count, Read<pos>, Write<>, Exclude<>, Dependency<>, ReadRes<Step>, WriteRes<Stats>> {
+    void process(entities_view const& view, Step const&, Stats& stats) const noexcept {
+        stats.moved += static_cast<int>(view.size());
+    }
+};
+
+struct Poll : SystemBase<Poll, Read<vel>, Write<>, Exclude<>, Dependency<>, ReadRes<Input>> {
+    Task process(entities_view const&, Input const& input) const {
+        for (;;) {
+            (void)input.key;
+            co_await NextTick{};
+        }
+    }
+};
+
+struct CountToo : SystemBase<CountToo, Read<vel>, Write<>, Exclude<>, Dependency<>, ReadRes<>, WriteRes<Stats>> {
+    void process(entities_view const&, Stats&) const noexcept {}
+};
+
+static_assert(Poll::returnsTask() && !Count::returnsTask());
+
+// systems writing a resource conflict with every other system using it, readers don't conflict with each other.
+void access() {
+    assert(detail::conflicts(Move::access(), Count::access()));
+    assert(!detail::conflicts(Count::access(), Poll::access()));
+    assert(detail::conflicts(Count::access(), CountToo::access()));
+}
+
+// resources are default constructed on first use, and setting one is seen from the next update on.
+void setAndRead() {
+    JobSystem jobs{3};
+    World world{jobs};
+    auto& r = world.registry();
+    for (int i = 0; i < 10; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e, pos{{}, 0.f});
+        r.emplace<vel>(e, vel{{}, 2.f});
+    }
+    world.emplaceSystem<Move>();
+    world.emplaceSystem<Count>();
+    world.emplaceSystem<Poll>();
+
+    world.update(Time{1});
+    assert(world.resource<Stats>().moved == 10);
+    world.setResource<Step>(Step{1.f});
+    world.update(Time{1});
+    for (auto const e : r.view<pos>())
+        assert(r.get<pos>(e).x == 3.f);
+    assert(world.resource<Stats>().moved == 20);
+}
+
+int main() {
+    access();
+    setAndRead();
+}
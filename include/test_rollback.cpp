@@ -0,0 +1,168 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "delta.hpp"
+#include "rollback.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x, y; };
+struct vel : component_base { float dx, dy; };
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>> {
+    void process(pos& p, vel const& v) const noexcept {
+        p.x += v.dx;
+        p.y += v.dy;
+    }
+};
+
+struct Input { std::uint32_t seed = 0; };
+
+// the alive entities and the bytes of every component in slot order, and the entities created next.
+struct State {
+    std::vector<Entity> entities;
+    std::vector<Entity> next;
+    std::vector<std::byte> components;
+
+    friend bool operator==(State const&, State const&) = default;
+};
+
+// Hands out the destroyed entities to see their order and puts them back as they were. Destroyed slots at the end
+// of the list, which are handed out just like new slots, count as not being there.
+State capture(entt::registry& r) {
+    State s;
+    while (r.alive() != r.size())
+        s.next.push_back(r.create());
+    for (auto it = s.next.rbegin(); it != s.next.rend(); ++it)
+        r.destroy(*it, detail::entity_version(*it));
+    auto size = r.size();
+    while (!s.next.empty() && s.next.back() == detail::entity_at(size - 1, 0)) {
+        s.next.pop_back();
+        --size;
+    }
+    auto const append = [&s](void const* p, std::size_t const size) {
+        auto const offset = s.components.size();
+        s.components.resize(offset + size);
+        std::memcpy(s.components.data() + offset, p, size);
+    };
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        auto const e = r.data()[i];
+        if (!detail::is_alive_at(e, i))
+            continue;
+        s.entities.push_back(e);
+        if (auto const* const p = r.try_get<pos>(e))
+            append(p, sizeof(pos));
+        if (auto const* const v = r.try_get<vel>(e))
+            append(v, sizeof(vel));
+    }
+    return s;
+}
+
+// structural changes picked among the alive entities in slot order, so they only depend on the seed and the entities.
+void churn(entt::registry& r, std::uint32_t const seed) {
+    std::mt19937 rng{seed};
+    std::vector<Entity> alive;
+    for (int k = 0; k < 40; ++k) {
+        alive.clear();
+        for (std::size_t i = 0; i < r.size(); ++i) {
+            if (detail::is_alive_at(r.data()[i], i))
+                alive.push_back(r.data()[i]);
+        }
+        auto const op = rng() % 4;
+        auto const pick = rng();
+        auto const e = alive.empty() ? Entity{entt::null} : alive[pick % alive.size()];
+        if (op == 0 || alive.empty()) {
+            auto const created = r.create();
+            r.emplace<pos>(created, pos{{}, static_cast<float>(rng() % 100), 0.f});
+            if (rng() % 2 == 0)
+                r.emplace<vel>(created, vel{{}, 1.f, static_cast<float>(rng() % 3)});
+        }
+        else if (op == 1) {
+            r.destroy(e);
+        }
+        else if (op == 2) {
+            r.emplace_or_replace<vel>(e, vel{{}, static_cast<float>(rng() % 5), 1.f});
+        }
+        else {
+            r.remove_if_exists<vel>(e);
+        }
+    }
+}
+
+// An entity created and destroyed within a tick leaves its slot behind. Rewinding frees it again with its first
+// version, so resimulating the tick hands out the same entities.
+void rewindRestoresEntityList() {
+    entt::registry r;
+    DeltaRecorder<pos> recorder;
+    recorder.reset(r);
+
+    auto const first = r.create();
+    r.destroy(first);
+    auto const second = r.create();
+    std::vector<std::byte> delta;
+    std::vector<std::byte> undo;
+    recorder.record(r, 0, delta, &undo);
+
+    assert(recorder.rewind(r, undo));
+    assert(r.alive() == 0);
+    auto const again = r.create();
+    r.destroy(again);
+    assert(again == first);
+    assert(r.create() == second);
+}
+
+// Rewinding 30 ticks of random churn and resimulating them with the same inputs goes through the same states.
+void resimulationIsIdentical() {
+    World world;
+    world.emplaceSystem<Move>();
+    auto& r = world.registry();
+    Rollback<Input, pos, vel> rollback{world, Time{16}, 32};
+
+    std::vector<State> states;
+    for (std::uint32_t t = 0; t < 40; ++t) {
+        churn(r, t);
+        rollback.advance(Input{t});
+        states.push_back(capture(r));
+    }
+
+    assert(rollback.rewind(10));
+    assert(capture(r) == states[9]);
+    for (std::uint32_t t = 10; t < 40; ++t) {
+        churn(r, t);
+        rollback.advance(Input{t});
+        assert(capture(r) == states[t]);
+    }
+}
+
+// Resimulated ticks see the same tick numbers and times as the first time.
+void rewindRestoresClock() {
+    World world;
+    world.update(Time{5});
+    Rollback<Input, pos> rollback{world, Time{16}, 8};
+
+    std::vector<std::pair<std::uint64_t, Time>> clocks;
+    for (std::uint32_t t = 0; t < 8; ++t) {
+        clocks.emplace_back(world.scheduler().tick(), world.scheduler().now());
+        rollback.advance(Input{t});
+    }
+
+    assert(rollback.rewind(3));
+    for (std::uint32_t t = 3; t < 8; ++t) {
+        assert(world.scheduler().tick() == clocks[t].first);
+        assert(world.scheduler().now() == clocks[t].second);
+        assert(world.elapsed() == clocks[t].second);
+        rollback.advance(Input{t});
+    }
+}
+
+int main() {
+    rewindRestoresEntityList();
+    resimulationIsIdentical();
+    rewindRestoresClock();
+}
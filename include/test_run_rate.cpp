@@ -0,0 +1,82 @@
+#undef NDEBUG
+#include <cassert>
+#include <vector>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct hits : component_base { int n = 0; };
+
+static_assert(detail::spread(0, Time{100}) == Time{0});
+static_assert(detail::spread(1, Time{100}) == Time{50});
+static_assert(detail::spread(2, Time{100}) == Time{25});
+static_assert(detail::spread(3, Time{100}) == Time{75});
+
+// the number of World updates so far, for systems to note when they ran.
+inline int tick = 0;
+
+template<int N>
+struct EveryFour : SystemBase<EveryFour<N>, Read<pos>> {
+    static constexpr RunRate rate = RunRate::everyTicks(4);
+    mutable std::vector<int> runs;
+
+    void process(typename EveryFour::entities_view const&) const {
+        runs.push_back(tick);
+    }
+};
+
+struct TenHertz : SystemBase<TenHertz, Read<pos>> {
+    static constexpr RunRate rate = RunRate::hertz(10);
+    mutable int runs = 0;
+
+    void process(entities_view const&) const {
+        ++runs;
+    }
+};
+
+struct Partitioned : SystemBase<Partitioned, Read<>, Write<hits>> {
+    static constexpr RunRate rate = RunRate::partitionedOver(3);
+
+    void process(hits& h) const noexcept {
+        ++h.n;
+    }
+};
+
+// Systems sharing a rate run that often on different ticks, a system with an interval runs once per interval of
+// simulated time, and a partitioned system processes every entity once per `ticks` ticks.
+void rates() {
+    JobSystem jobs{3};
+    World world{jobs};
+    auto& r = world.registry();
+    for (int i = 0; i < 10; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e);
+        r.emplace<hits>(e);
+    }
+    world.emplaceSystem<EveryFour<0>>();
+    world.emplaceSystem<EveryFour<1>>();
+    world.emplaceSystem<TenHertz>();
+    world.emplaceSystem<Partitioned>();
+
+    for (tick = 0; tick < 12; ++tick)
+        world.update(Time{16});
+
+    auto const& first = world.getSystem<EveryFour<0>>().runs;
+    auto const& second = world.getSystem<EveryFour<1>>().runs;
+    assert(first.size() == 3 && second.size() == 3);
+    for (std::size_t i = 1; i < first.size(); ++i)
+        assert(first[i] - first[i - 1] == 4 && second[i] - second[i - 1] == 4);
+    assert(first[0] % 4 != second[0] % 4);
+
+    // 12 ticks of 16ms cover [0, 192ms), the only 10 Hz system isn't offset and runs at 0 and 100ms.
+    assert(world.getSystem<TenHertz>().runs == 2);
+
+    for (auto const e : r.view<hits>())
+        assert(r.get<hits>(e).n == 4);
+}
+
+int main() {
+    rates();
+}
@@ -0,0 +1,187 @@
+#undef NDEBUG
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "jobs.hpp"
+#include "schedule.hpp"
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+struct hp : component_base { int value; };
+
+struct WritePos : SystemBase<WritePos, Read<>, Write<pos>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+struct ReadPos : SystemBase<ReadPos, Read<pos>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+struct AlsoReadPos : SystemBase<AlsoReadPos, Read<pos>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+struct WriteVel : SystemBase<WriteVel, Read<>, Write<vel>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+struct AfterVel : SystemBase<AfterVel, Read<hp>, Write<>, Exclude<>, Dependency<WriteVel>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+template<class S>
+detail::system_arena::entry entryOf(S& s, std::uint32_t const slot) {
+    return {&s, nullptr, 0, S::getDependencies(), S::access(), slot, slot};
+}
+
+// the batch the i-th entry ended up in.
+std::size_t batchOf(detail::stage_schedule const& schedule, std::uint32_t const i) {
+    auto const k = std::find(schedule.order.begin(), schedule.order.end(), i) - schedule.order.begin();
+    return std::upper_bound(schedule.batches.begin(), schedule.batches.end(), static_cast<std::uint32_t>(k))
+        - schedule.batches.begin();
+}
+
+// Readers of a component share a batch and a writer added after them runs in a later one, as does a system after
+// its dependency. Systems touching nothing in common run alongside each other.
+void conflictsAreBatched() {
+    WritePos write_pos;
+    ReadPos read_pos;
+    AlsoReadPos also_read_pos;
+    WriteVel write_vel;
+    AfterVel after_vel;
+    std::vector const entries = {
+        entryOf(read_pos, 0), entryOf(also_read_pos, 1), entryOf(write_vel, 2), entryOf(after_vel, 3), entryOf(write_pos, 4)};
+
+    detail::stage_schedule schedule;
+    detail::build_schedule(entries, schedule);
+    assert(schedule.order.size() == entries.size());
+    assert(schedule.batches.size() == 2);
+    assert(batchOf(schedule, 0) == 0 && batchOf(schedule, 1) == 0 && batchOf(schedule, 2) == 0);
+    assert(batchOf(schedule, 3) == 1 && batchOf(schedule, 4) == 1);
+    assert(detail::conflicts(WritePos::access(), ReadPos::access()));
+    assert(!detail::conflicts(ReadPos::access(), AlsoReadPos::access()));
+    assert(!detail::conflicts(WritePos::access(), WriteVel::access()));
+}
+
+// Measured costs put the longest chain first, and cheap systems of a batch share a chunk.
+void costsSteerTheOrder() {
+    ReadPos read_pos;
+    AlsoReadPos also_read_pos;
+    WriteVel write_vel;
+    AfterVel after_vel;
+    std::vector const entries = {entryOf(read_pos, 0), entryOf(also_read_pos, 1), entryOf(write_vel, 2), entryOf(after_vel, 3)};
+
+    detail::stage_schedule schedule;
+    schedule.costs = {std::chrono::microseconds{1}, std::chrono::microseconds{1}, std::chrono::microseconds{300},
+                      std::chrono::microseconds{300}};
+    detail::build_schedule(entries, schedule);
+    assert(schedule.order.front() == 2);
+    assert(schedule.criticalPath() == std::chrono::microseconds{600});
+    // the two readers are packed behind the writer of vel.
+    assert(schedule.chunks.front() == 1 && schedule.chunks[1] == 3);
+}
+
+struct AlsoWritePos : SystemBase<AlsoWritePos, Read<>, Write<pos>> {
+    void process(entities_view const&) const noexcept {}
+};
+
+// Costs order the systems that don't conflict, but conflicting systems keep the order they were added in.
+void costsKeepConflictOrder() {
+    WritePos write_pos;
+    AlsoWritePos also_write_pos;
+    std::vector const entries = {entryOf(also_write_pos, 0), entryOf(write_pos, 1)};
+    auto reversed = entries;
+    std::swap(reversed[0].sequence, reversed[1].sequence);
+
+    detail::stage_schedule schedule;
+    schedule.costs = {std::chrono::microseconds{1}, std::chrono::microseconds{500}};
+    detail::build_schedule(entries, schedule);
+    assert((schedule.order == std::vector<std::uint32_t>{0, 1}));
+
+    schedule.costs = {std::chrono::microseconds{1}, std::chrono::microseconds{500}};
+    detail::build_schedule(reversed, schedule);
+    assert((schedule.order == std::vector<std::uint32_t>{1, 0}));
+}
+
+struct Double : SystemBase<Double, Read<>, Write<pos>> {
+    void process(pos& p) const noexcept {
+        p.x *= 2.f;
+    }
+};
+
+struct SlowAddOne : SystemBase<SlowAddOne, Read<>, Write<pos>> {
+    void process(pos& p) const noexcept {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        p.x += 1.f;
+    }
+};
+
+// replanning with measured costs doesn't change what two systems writing the same component compute.
+void replanKeepsResults() {
+    World world;
+    world.replanEvery(2);
+    auto& r = world.registry();
+    auto const e = r.create();
+    r.emplace<pos>(e);
+    world.emplaceSystem<Double>();
+    world.emplaceSystem<SlowAddOne>();
+    for (int t = 0; t < 10; ++t) {
+        r.get<pos>(e).x = 1.f;
+        world.update(Time{1});
+        assert(r.get<pos>(e).x == 3.f);
+    }
+}
+
+// never more than one system touching a component a system writes runs at a time.
+struct Usage {
+    std::atomic<int> readers{0};
+    std::atomic<int> writers{0};
+    std::atomic<bool> overlapped{false};
+};
+
+inline Usage usage;
+
+template<int N>
+struct Reader : SystemBase<Reader<N>, Read<pos>> {
+    void process(typename Reader::entities_view const&) const noexcept {
+        ++usage.readers;
+        if (usage.writers.load() != 0)
+            usage.overlapped = true;
+        --usage.readers;
+    }
+};
+
+template<int N>
+struct Writer : SystemBase<Writer<N>, Read<>, Write<pos>> {
+    void process(typename Writer::entities_view const&) const noexcept {
+        if (usage.writers++ != 0 || usage.readers.load() != 0)
+            usage.overlapped = true;
+        --usage.writers;
+    }
+};
+
+void conflictingSystemsNeverOverlap() {
+    JobSystem jobs{4};
+    World world{jobs};
+    world.registry().emplace<pos>(world.registry().create());
+    world.addSystems<Reader<0>, Writer<0>, Reader<1>, Reader<2>, Writer<1>, Reader<3>>();
+    for (int t = 0; t < 500; ++t)
+        world.update(Time{1});
+    assert(!usage.overlapped);
+}
+
+int main() {
+    conflictsAreBatched();
+    costsSteerTheOrder();
+    costsKeepConflictOrder();
+    replanKeepsResults();
+    conflictingSystemsNeverOverlap();
+}
@@ -0,0 +1,74 @@
+#undef NDEBUG
+#include <cassert>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+struct hp : component_base { int value; };
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>> {
+    void process(pos& p, vel const& v) const noexcept {
+        p.x += v.dx;
+    }
+};
+
+struct Heal : SystemBase<Heal, Read<>, Write<hp>> {
+    void process(hp& h) const noexcept {
+        ++h.value;
+    }
+};
+
+struct CountHp : SystemBase<CountHp, Read<hp>> {
+    mutable int runs = 0;
+
+    void process(entities_view const&) const noexcept {
+        ++runs;
+    }
+};
+
+struct AlwaysCountHp : SystemBase<AlwaysCountHp, Read<hp>> {
+    static constexpr bool run_when_empty = true;
+    mutable int runs = 0;
+
+    void process(entities_view const&) const noexcept {
+        ++runs;
+    }
+};
+
+static_assert(Heal::skippable() && CountHp::skippable() && !AlwaysCountHp::skippable());
+
+// a system isn't dispatched while one of its pools is empty, unless it asks to run anyway.
+void skipsEmptyPools() {
+    JobSystem jobs{3};
+    World world{jobs};
+    auto& r = world.registry();
+    for (int i = 0; i < 10; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e, pos{{}, 0.f});
+        r.emplace<vel>(e, vel{{}, 2.f});
+    }
+    world.emplaceSystem<Move>();
+    world.emplaceSystem<Heal>();
+    world.emplaceSystem<CountHp>();
+    world.emplaceSystem<AlwaysCountHp>();
+
+    for (int t = 0; t < 3; ++t)
+        world.update(Time{1});
+    assert(world.getSystem<CountHp>().runs == 0);
+    assert(world.getSystem<AlwaysCountHp>().runs == 3);
+    for (auto const e : r.view<pos>())
+        assert(r.get<pos>(e).x == 6.f);
+
+    auto const e = r.create();
+    r.emplace<hp>(e, hp{{}, 0});
+    world.update(Time{1});
+    assert(world.getSystem<CountHp>().runs == 1);
+    assert(r.get<hp>(e).value == 1);
+}
+
+int main() {
+    skipsEmptyPools();
+}
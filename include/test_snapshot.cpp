@@ -0,0 +1,123 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+#include "snapshot.hpp"
+
+using namespace nova;
+
+struct pos : paged_component_base { float x, y; };
+struct vel : component_base { float dx, dy; };
+struct tag : component_base {};
+
+using Save = Snapshot<pos, vel, tag>;
+
+void populate(entt::registry& r) {
+    for (int i = 0; i < 10000; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e, pos{{}, static_cast<float>(i), 0.f});
+        r.emplace<vel>(e, vel{{}, static_cast<float>(2 * i), 0.f});
+        if (i % 3 == 0)
+            r.emplace<tag>(e);
+    }
+    for (int i = 0; i < 100; ++i)
+        r.destroy(Entity(i * 7));
+}
+
+// the loaded registry has the same components and hands out the same entities next.
+void matches(entt::registry& saved, entt::registry& loaded) {
+    assert(loaded.alive() == saved.alive());
+    assert(loaded.size<pos>() == saved.size<pos>() && loaded.size<vel>() == saved.size<vel>());
+    assert(loaded.size<tag>() == saved.size<tag>());
+    saved.view<pos const, vel const>().each([&loaded, &saved](auto const e, pos const& p, vel const& v) {
+        assert(loaded.valid(e));
+        assert(loaded.get<pos>(e).x == p.x && loaded.get<vel>(e).dx == v.dx);
+        assert(loaded.has<tag>(e) == saved.has<tag>(e));
+    });
+    assert(loaded.create() == saved.create());
+}
+
+void roundTripFile() {
+    entt::registry saved;
+    populate(saved);
+    auto const path = std::filesystem::temp_directory_path() / "nova_test_snapshot.bin";
+    assert(Save::save(saved, path));
+
+    entt::registry loaded;
+    assert(Save::load(loaded, path));
+    std::filesystem::remove(path);
+    matches(saved, loaded);
+}
+
+void roundTripMemory() {
+    entt::registry saved;
+    populate(saved);
+    std::vector<std::byte> bytes;
+    Save::write(saved, bytes);
+
+    entt::registry loaded;
+    assert(Save::read(loaded, bytes));
+    matches(saved, loaded);
+}
+
+// pools the reading type doesn't list are skipped.
+void skipsUnknownPools() {
+    entt::registry saved;
+    populate(saved);
+    std::vector<std::byte> bytes;
+    Save::write(saved, bytes);
+
+    entt::registry loaded;
+    assert(Snapshot<vel>::read(loaded, bytes));
+    assert(loaded.alive() == saved.alive());
+    assert(loaded.size<vel>() == saved.size<vel>() && loaded.size<pos>() == 0);
+}
+
+// truncated or corrupt data and data that isn't a snapshot are rejected, leaving the registry as it was.
+void rejectsBadData() {
+    entt::registry saved;
+    populate(saved);
+    std::vector<std::byte> bytes;
+    Save::write(saved, bytes);
+
+    entt::registry loaded;
+    auto const kept = loaded.create();
+    loaded.emplace<pos>(kept, pos{{}, 3.f, 4.f});
+    auto const untouched = [&loaded, kept] {
+        return loaded.alive() == 1 && loaded.size<pos>() == 1 && loaded.size<vel>() == 0 && loaded.get<pos>(kept).x == 3.f;
+    };
+
+    assert(!Save::read(loaded, std::span{bytes}.first(bytes.size() - 1)));
+    assert(untouched());
+
+    // the byte size of a pool whose size is this large wraps around to 0.
+    auto const pool_offset = detail::align_snapshot(detail::align_snapshot(sizeof(detail::snapshot_header)) + saved.size() * sizeof(Entity));
+    auto corrupt = bytes;
+    auto const huge = std::numeric_limits<std::uint64_t>::max() / sizeof(Entity) + 1;
+    std::memcpy(corrupt.data() + pool_offset + offsetof(detail::pool_header, size), &huge, sizeof(huge));
+    assert(!Save::read(loaded, corrupt));
+    assert(untouched());
+
+    // slot 0 was destroyed, so its first version isn't in the entity list.
+    corrupt = bytes;
+    auto const destroyed = Entity(0);
+    std::memcpy(corrupt.data() + detail::align_snapshot(pool_offset + sizeof(detail::pool_header)), &destroyed, sizeof(destroyed));
+    assert(!Save::read(loaded, corrupt));
+    assert(untouched());
+
+    bytes[0] = ~bytes[0];
+    assert(!Save::read(loaded, bytes));
+    assert(untouched());
+}
+
+int main() {
+    roundTripFile();
+    roundTripMemory();
+    skipsUnknownPools();
+    rejectsBadData();
+}
@@ -0,0 +1,70 @@
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "allocator.hpp"
+#include "entity.hpp"
+#include "storage.hpp"
+
+using namespace nova;
+
+struct pos : paged_component_base {
+    pos() = default;
+    pos(float const x, float const y) : x(x), y(y) {}
+    float x = 0.f;
+    float y = 0.f;
+};
+
+// pages are aligned to their size and recycled.
+void pagePool() {
+    PagePool pool{std::size_t{64} << 10};
+    auto* const first = pool.allocate();
+    auto* const second = pool.allocate();
+    assert(first != second);
+    assert(reinterpret_cast<std::uintptr_t>(first) % pool.pageSize() == 0);
+    assert(reinterpret_cast<std::uintptr_t>(second) % pool.pageSize() == 0);
+    pool.deallocate(second);
+    assert(pool.allocate() == second);
+}
+
+// Growing a paged pool never moves the components already in it, and the pool behaves like a regular one for
+// iteration, removal, sorting and bulk inserts.
+void pagedStorage() {
+    entt::registry r;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 100000; ++i) {
+        auto const e = entities.emplace_back(r.create());
+        r.emplace<pos>(e, static_cast<float>(i), 1.f);
+    }
+    auto const* const address = &r.get<pos>(entities[5]);
+    for (int i = 0; i < 100000; ++i)
+        r.emplace<pos>(r.create(), static_cast<float>(100000 + i), 1.f);
+    assert(&r.get<pos>(entities[5]) == address);
+
+    double sum = 0.0;
+    r.view<pos const>().each([&sum](pos const& p) { sum += p.x; });
+    assert(sum == 199999.0 * 200000.0 / 2.0);
+
+    for (int i = 0; i < 1000; ++i)
+        r.destroy(entities[i]);
+    assert(r.size<pos>() == 199000);
+    assert(r.get<pos>(entities[1000]).x == 1000.f);
+
+    r.sort<pos>([](pos const& a, pos const& b) { return a.x < b.x; });
+    std::vector<float> order;
+    r.view<pos const>().each([&order](pos const& p) { order.push_back(p.x); });
+    assert(std::is_sorted(order.begin(), order.end()));
+
+    std::vector<Entity> spawned(10);
+    r.create(spawned.begin(), spawned.end());
+    r.insert<pos>(spawned.begin(), spawned.end(), pos{3.f, 4.f});
+    for (auto const e : spawned)
+        assert(r.get<pos>(e).y == 4.f);
+}
+
+int main() {
+    pagePool();
+    pagedStorage();
+}
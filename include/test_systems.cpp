@@ -0,0 +1,59 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+
+template<int N>
+struct Add : SystemBase<Add<N>, Read<>, Write<pos>> {
+    void process(pos& p) const noexcept {
+        p.x += static_cast<float>(N);
+    }
+};
+
+// Systems are found and removed by type or by handle, and a handle doesn't match the system that reuses its slot.
+void lookupAndRemoval() {
+    World world;
+    auto const first = world.addSystem(std::make_unique<Add<1>>());
+    world.addSystem(std::make_unique<Add<2>>());
+    auto const third = world.addSystem(std::make_unique<Add<4>>());
+    assert(world.numSystems() == 3);
+
+    auto const removed = world.removeSystem<Add<1>>();
+    assert(removed && !world.contains(first) && world.contains(third));
+
+    auto const reused = world.addSystem(std::make_unique<Add<8>>());
+    assert(reused.slot == first.slot && !world.contains(first) && world.contains(reused));
+
+    world.removeSystem(third);
+    assert(!world.contains<Add<4>>() && world.contains<Add<2>>());
+    world.removeSystem<Add<2>>();
+    world.removeSystem(reused);
+    assert(world.numSystems() == 0);
+}
+
+// systems added and removed between updates run from where they are stored now, emplaced or boxed.
+void runsStoredSystems() {
+    World world;
+    auto& r = world.registry();
+    auto const e = r.create();
+    r.emplace<pos>(e, pos{{}, 0.f});
+    world.emplaceSystem<Add<1>>();
+    world.addSystem(std::make_unique<Add<2>>());
+    world.update(Time{1});
+    assert(r.get<pos>(e).x == 3.f);
+
+    world.removeSystem<Add<1>>();
+    world.emplaceSystem<Add<4>>();
+    world.update(Time{1});
+    assert(r.get<pos>(e).x == 9.f);
+}
+
+int main() {
+    lookupAndRemoval();
+    runsStoredSystems();
+}
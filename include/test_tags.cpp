@@ -0,0 +1,84 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "tags.hpp"
+
+using namespace nova;
+
+struct a : component_base {};
+struct b : component_base {};
+struct c : component_base {};
+
+// the number of entities the view yields, to check the bitsets against.
+template<class View>
+std::size_t count(View const& view) {
+    std::size_t n = 0;
+    for ([[maybe_unused]] auto const e : view)
+        ++n;
+    return n;
+}
+
+// the bitsets give the same entities as a view, whether tags were added before or after they were built.
+void matchesViews() {
+    entt::registry r;
+    std::mt19937 rng{3};
+    std::vector<Entity> entities;
+    for (int i = 0; i < 5000; ++i) {
+        auto const e = entities.emplace_back(r.create());
+        if (rng() % 2 == 0)
+            r.emplace<a>(e);
+        if (rng() % 3 != 0)
+            r.emplace<b>(e);
+    }
+    (void)tagBits<a>(r);
+
+    for (auto const e : entities) {
+        if (rng() % 4 == 0)
+            r.emplace<c>(e);
+    }
+    for (int i = 0; i < 500; ++i) {
+        auto const e = entities[rng() % entities.size()];
+        if (r.valid(e))
+            r.destroy(e);
+    }
+
+    std::size_t n = 0;
+    eachTagged<a, b>(r, entt::exclude<c>, [&r, &n](Entity const e) {
+        assert(r.valid(e) && r.has<a>(e) && r.has<b>(e) && !r.has<c>(e));
+        ++n;
+    });
+    assert(n == count(r.view<a, b>(entt::exclude<c>)));
+
+    for (int i = 0; i < 300; ++i) {
+        auto const e = r.create();
+        r.emplace<a>(e);
+        r.emplace<b>(e);
+    }
+    assert((countTagged<a, b>(r, entt::exclude<c>) == count(r.view<a, b>(entt::exclude<c>))));
+    assert(countTagged<a>(r) == r.size<a>());
+}
+
+// removing a tag clears its bit, also when the entity's slot is reused.
+void removeClearsBit() {
+    entt::registry r;
+    auto const e = r.create();
+    r.emplace<a>(e);
+    assert(tagBits<a>(r).test(detail::entity_index(e)));
+
+    r.remove<a>(e);
+    assert(!tagBits<a>(r).test(detail::entity_index(e)));
+
+    r.emplace<a>(e);
+    r.destroy(e);
+    auto const reused = r.create();
+    assert(detail::entity_index(reused) == detail::entity_index(e));
+    assert(countTagged<a>(r) == 0);
+}
+
+int main() {
+    matchesViews();
+    removeClearsBit();
+}
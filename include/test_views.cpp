@@ -0,0 +1,72 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+
+#include "world.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+struct tag : component_base {};
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>> {
+    void process(pos& p, vel const& v) const noexcept {
+        p.x += v.dx;
+    }
+};
+
+struct Untagged : SystemBase<Untagged, Read<vel, pos>, Write<>, Exclude<tag>> {
+    mutable int seen = 0;
+
+    void process(Entity, pos const&) const noexcept {
+        ++seen;
+    }
+};
+
+struct Count : SystemBase<Count, Read<pos>> {
+    mutable int seen = 0;
+
+    void process(entities_view const& view) const noexcept {
+        seen += static_cast<int>(view.size());
+    }
+};
+
+// Views cached by the systems follow the entities added between updates, the registry the World is moved into
+// and, when a system is run by hand, the registry it is given.
+void viewsFollowTheRegistry() {
+    World world;
+    auto& r = world.registry();
+    for (int i = 0; i < 10; ++i) {
+        auto const e = r.create();
+        r.emplace<pos>(e, pos{{}, 0.f});
+        r.emplace<vel>(e, vel{{}, 1.f});
+        if (i < 3)
+            r.emplace<tag>(e);
+    }
+    world.addSystem(std::make_unique<Move>());
+    world.addSystem(std::make_unique<Untagged>());
+    world.addSystem(std::make_unique<Count>());
+
+    world.update(Time{1});
+    world.update(Time{1});
+    for (auto const e : r.view<pos>())
+        assert(r.get<pos>(e).x == 2.f);
+    assert(world.getSystem<Untagged>().seen == 14 && world.getSystem<Count>().seen == 20);
+
+    World moved = std::move(world);
+    auto& m = moved.registry();
+    m.emplace<pos>(m.create(), pos{{}, 5.f});
+    moved.update(Time{1});
+    assert(moved.getSystem<Count>().seen == 31);
+
+    entt::registry other;
+    other.emplace<pos>(other.create());
+    Count count;
+    count.processImpl(other);
+    assert(count.seen == 1);
+}
+
+int main() {
+    viewsFollowTheRegistry();
+}
@@ -0,0 +1,73 @@
+#undef NDEBUG
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "world_host.hpp"
+
+using namespace nova;
+
+struct pos : component_base { float x; };
+struct vel : component_base { float dx; };
+
+struct Move : SystemBase<Move, Read<vel>, Write<pos>> {
+    void process(pos& p, vel const& v) const noexcept {
+        p.x += v.dx;
+    }
+};
+
+// every world ticks once per step of its own, however many share the workers.
+void ticksEveryWorld() {
+    JobSystem jobs{4};
+    WorldHost host{jobs};
+    std::vector<WorldId> ids;
+    for (int w = 0; w < 200; ++w) {
+        auto& world = host.add({Time{10 + w % 3}});
+        world.emplaceSystem<Move>();
+        auto& r = world.registry();
+        for (int i = 0; i < 50; ++i) {
+            auto const e = r.create();
+            r.emplace<pos>(e, pos{{}, 0.f});
+            r.emplace<vel>(e, vel{{}, 1.f});
+        }
+        ids.push_back(world.id());
+    }
+
+    ManualClock clock;
+    host.run(clock, [&clock] { return clock.now() >= Time{1000}; });
+    // ticks at 0, step, 2 * step... up to 1000ms excluded.
+    for (std::size_t w = 0; w < ids.size(); ++w) {
+        auto* const world = host.get(ids[w]);
+        auto const ticks = world->scheduler().tick();
+        assert(ticks == 1 + 999 / (10 + w % 3));
+        for (auto const e : world->registry().view<pos const>())
+            assert(world->registry().get<pos>(e).x == static_cast<float>(ticks));
+    }
+
+    host.remove(ids[3]);
+    assert(host.get(ids[3]) == nullptr && host.size() == 199);
+    assert(host.get(ids.back()) != nullptr);
+}
+
+// A world behind catches up one tick per round, and one behind by `max_lag` steps or more drops the missed ticks.
+void catchesUp() {
+    WorldHost host;
+    auto const id = host.add({Time{10}, std::chrono::milliseconds{2}, 5}).id();
+    auto& scheduler = host.get(id)->scheduler();
+
+    host.tick(Time{30});
+    assert(scheduler.tick() == 1 && host.nextDue() == Time{10});
+    host.tick(Time{30});
+    host.tick(Time{30});
+    host.tick(Time{30});
+    host.tick(Time{30});
+    assert(scheduler.tick() == 4 && host.nextDue() == Time{40});
+
+    host.tick(Time{100});
+    assert(scheduler.tick() == 5 && host.nextDue() == Time{110});
+}
+
+int main() {
+    ticksEveryWorld();
+    catchesUp();
+}
@@ -1,76 +1,479 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <concepts>
+#include <cstdint>
+#include <memory>
 #include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "entity.hpp"
+#include "events.hpp"
+#include "jobs.hpp"
+#include "schedule.hpp"
+#include "snapshot.hpp"
 #include "system.hpp"
+#include "system_arena.hpp"
+#include "task.hpp"
 #include "util.hpp"
 
 namespace nova {
 
-using Time = std::chrono::milliseconds;
-
+// Refers to a system added to a World. The generation tells a handle to a removed system
+// apart from a handle to whichever system reuses its slot.
 struct SystemHandle {
     SystemId id;
     bool hasDependency;
+    std::uint32_t slot;
+    std::uint32_t generation;
 };
 
+namespace detail {
+
+inline std::atomic<WorldId> next_world_id{1};
+
+} // namespace detail
+
 class World {
+    WorldId id_ = detail::next_world_id.fetch_add(1, std::memory_order_relaxed);
     entt::registry reg_;
 
-    struct dependent_system {
-        std::unique_ptr<ISystem> system;
-        SystemDependencyView deps;
+    // where a system currently lives, its index changes when its stage is rescheduled.
+    struct system_slot {
+        std::uint32_t index;
+        std::uint32_t generation;
+        Stage stage;
     };
 
-    std::vector<std::unique_ptr<ISystem>> independent_systems_;
-    std::vector<dependent_system> depdendent_systems_;
+    // systems are stored by value, one arena per stage kept in the order the stage runs them.
+    std::array<detail::system_arena, num_stages> stages_;
+    std::array<detail::stage_schedule, num_stages> schedules_;
+    bool scheduled_ = true;
+    entt::registry const* prepared_ = nullptr;
+    std::vector<system_slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+    std::unordered_map<SystemId, std::uint32_t> ids_;
+    // counts the systems ever added, the order conflicting systems run in.
+    std::uint64_t next_sequence_ = 0;
+    Time elapsed_{0};
+    std::chrono::nanoseconds last_update_{0};
+    std::uint64_t replan_interval_ = 120;
+    std::chrono::nanoseconds tick_budget_{0};
+    // how many systems were added with each rate, the next one is staggered after them.
+    std::vector<std::pair<RunRate, std::uint32_t>> rates_;
+    // the [begin, end) positions of the chunks of the current batch that have work to do.
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> active_chunks_;
+    JobSystem* jobs_ = nullptr;
+    std::vector<std::unique_ptr<detail::pending_job>> pending_jobs_;
+
+    detail::system_arena& stage(Stage const s) noexcept {
+        return stages_[static_cast<std::size_t>(s)];
+    }
+
+    std::uint32_t acquireSlot() {
+        if (free_slots_.empty()) {
+            slots_.push_back({0, 0, Stage::Update});
+            return static_cast<std::uint32_t>(slots_.size() - 1);
+        }
+        auto const slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    std::unique_ptr<ISystem> release(std::uint32_t const slot) {
+        auto& s = slots_[slot];
+        auto ptr = stage(s.stage).release(s.index);
+        ids_.erase(ptr->id());
+        ++s.generation;
+        free_slots_.push_back(slot);
+        scheduled_ = false;
+        return ptr;
+    }
+
+    // applies the results of finished jobs in submission order, jobs due this tick are waited for.
+    void sync() {
+        auto const tick = scheduler().tick();
+        std::erase_if(pending_jobs_, [this, tick](auto const& job) {
+            if (!job->ready()) {
+                if (job->deadline > tick)
+                    return false;
+                job->wait(jobs());
+            }
+            job->apply(reg_);
+            return true;
+        });
+    }
+
+    // rebuilds the schedule of every stage and lays the systems out in the order they run.
+    void reschedule() {
+        auto const moved = [this](std::uint32_t const slot, std::uint32_t const index) { slots_[slot].index = index; };
+        for (std::size_t i = 0; i < num_stages; ++i) {
+            for (auto const& entry : stages_[i].entries()) {
+                if (entry.system == nullptr)
+                    continue;
+                for (auto const dep : entry.deps) {
+                    [[maybe_unused]] auto const found = ids_.find(dep);
+                    NOVA_ASSERT((found == ids_.end() || static_cast<std::size_t>(slots_[found->second].stage) <= i)
+                        && "a system can't depend on a system of a later stage");
+                }
+            }
+            detail::build_schedule(stages_[i].entries(), schedules_[i]);
+            stages_[i].arrange(schedules_[i].order, moved);
+        }
+        scheduled_ = true;
+    }
+
+    // whether a system depending on `deps` would end up depending on `id`.
+    bool dependsOn(SystemDependencyView const deps, SystemId const id) const {
+        std::vector<SystemId> pending(deps.begin(), deps.end());
+        std::unordered_set<SystemId> seen;
+        while (!pending.empty()) {
+            auto const dep = pending.back();
+            pending.pop_back();
+            if (dep == id)
+                return true;
+            auto const found = ids_.find(dep);
+            if (found == ids_.end() || !seen.insert(dep).second)
+                continue;
+            auto const& s = slots_[found->second];
+            auto const& next = stages_[static_cast<std::size_t>(s.stage)].entries()[s.index].deps;
+            pending.insert(pending.end(), next.begin(), next.end());
+        }
+        return false;
+    }
+
+    std::uint32_t nextOrdinal(RunRate const& rate) {
+        auto const found = std::find_if(rates_.begin(), rates_.end(), [&rate](auto const& r) { return r.first == rate; });
+        if (found == rates_.end()) {
+            rates_.push_back({rate, 1});
+            return 0;
+        }
+        return found->second++;
+    }
+
+    // runs the systems in [begin, end) one after the other, measuring each of them.
+    void runChunk(std::size_t const i, std::uint32_t const begin, std::uint32_t const end) {
+        auto const& entries = stages_[i].entries();
+        auto& costs = schedules_[i].costs;
+        for (auto k = begin; k < end; ++k) {
+            if (entries[k].system->idle(reg_))
+                continue;
+            auto const start = std::chrono::steady_clock::now();
+            entries[k].system->processImpl(reg_);
+            std::chrono::nanoseconds const cost = std::chrono::steady_clock::now() - start;
+            // a moving average, so a single slow tick doesn't reorder the stage.
+            costs[k] = costs[k] == std::chrono::nanoseconds{0} ? cost : (costs[k] * 7 + cost) / 8;
+        }
+    }
+
+    void runStage(std::size_t const i) {
+        auto const& schedule = schedules_[i];
+        auto const& entries = stages_[i].entries();
+        std::uint32_t begin = 0;
+        std::size_t chunk = 0;
+        for (auto const end : schedule.batches) {
+            // chunks whose systems are all idle are dropped before dispatch, so they don't wake a worker.
+            active_chunks_.clear();
+            for (auto first = begin; first != end; ++chunk) {
+                auto const last = schedule.chunks[chunk];
+                if (std::any_of(entries.begin() + first, entries.begin() + last, [this](auto const& e) { return !e.system->idle(reg_); }))
+                    active_chunks_.push_back({first, last});
+                first = last;
+            }
+            if (active_chunks_.size() == 1) {
+                runChunk(i, active_chunks_[0].first, active_chunks_[0].second);
+            }
+            else if (active_chunks_.size() > 1) {
+                jobs().parallelFor(active_chunks_.size(), [this, i](std::size_t const c) {
+                    runChunk(i, active_chunks_[c].first, active_chunks_[c].second);
+                });
+            }
+            begin = end;
+        }
+        // the stage boundary, structural changes are applied in the order the systems ran.
+        for (auto const& entry : entries)
+            entry.system->flush(reg_);
+    }
 
 public:
+    static constexpr std::uint64_t no_deadline = static_cast<std::uint64_t>(-1);
+
+    World() = default;
+
+    explicit World(JobSystem& jobs) noexcept : jobs_(&jobs) {}
+
+    entt::registry& registry() noexcept {
+        return reg_;
+    }
+
+    entt::registry const& registry() const noexcept {
+        return reg_;
+    }
+
+    WorldId id() const noexcept {
+        return id_;
+    }
+
+    Handle handle(Entity const e) const noexcept {
+        return {id_, e};
+    }
+
+    // whether the handle refers to an entity of this World that is still alive.
+    bool valid(Handle const h) const {
+        return h.world == id_ && reg_.valid(h.entity);
+    }
+
+    bool valid(PackedEntity const e) const {
+        return e.valid(reg_);
+    }
+
+    // the entity a packed reference stands for, or null if it was destroyed.
+    Entity entity(PackedEntity const e) const {
+        return e.valid(reg_) ? e.unpack(reg_) : entt::null;
+    }
+
+    // constructs the system in place inside the World.
+    template<class S, class... Args>
+    requires std::derived_from<S, ISystem>
+    SystemHandle emplaceSystem(Args&&... args) {
+        static_assert(detail::acyclic_v<S>, "the system depends on itself");
+        auto const id = S::staticId();
+        NOVA_ASSERT(!ids_.contains(id));
+        // systems already added may depend on S before it exists, which closes a cycle through S's dependencies.
+        NOVA_ASSERT(!dependsOn(S::getDependencies(), id) && "adding the system creates a dependency cycle");
+
+        constexpr Stage s = detail::stage_of_v<S>;
+        auto const slot = acquireSlot();
+        auto& systems = stage(s);
+        if constexpr (S::returnsTask())
+            slots_[slot].index = systems.template emplace<detail::boxed_system<S>>(slot, next_sequence_, S::getDependencies(), S::access(), std::make_unique<S>(std::forward<Args>(args)...));
+        else
+            slots_[slot].index = systems.template emplace<S>(slot, next_sequence_, S::getDependencies(), S::access(), std::forward<Args>(args)...);
+        slots_[slot].stage = s;
+        ++next_sequence_;
+        // pools are resolved when the system is added rather than during its first update.
+        auto* const system = systems.entries()[slots_[slot].index].system;
+        system->prepare(reg_);
+        if constexpr (detail::staggered(detail::rate_of<S>()))
+            system->stagger(nextOrdinal(detail::rate_of<S>()), scheduler().now());
+        ids_.emplace(id, slot);
+        scheduled_ = false;
+
+        return {id, S::numDependencies() > 0, slot, slots_[slot].generation};
+    }
+
+    // adds systems known together at compile time, their dependencies are checked for cycles while compiling.
+    template<class... Ss>
+    requires (std::derived_from<Ss, ISystem> && ...)
+    std::array<SystemHandle, sizeof...(Ss)> addSystems() {
+        static_assert(detail::acyclic_v<Ss...>, "the systems depend on each other in a cycle");
+        return {emplaceSystem<Ss>()...};
+    }
+
+    // the system is moved into the World's storage, the pointer itself isn't kept.
     template<class S>
     requires std::derived_from<S, ISystem>
     SystemHandle addSystem(std::unique_ptr<S> system) {
-        auto const id = system->id();
-        if constexpr (S::numDependencies() > 0) {
-            NOVA_ASSERT(std::none_of(std::begin(depdendent_systems_), std::end(depdendent_systems_), 
-                [id](auto const& sys) { return sys.system->id() == id; }));
-            depdendent_systems_.emplace_back(std::move(system), S::getDependencies());
-        }
-        else { // no dependenceis
-            NOVA_ASSERT(std::none_of(std::begin(independent_systems_), std::end(independent_systems_), 
-                [id](auto const& sys) { return sys->id() == id; }));
-            independent_systems_.push_back(std::move(system));
-        }
-        return {id, S::numDependencies() > 0};
-    } 
+        return emplaceSystem<S>(std::move(*system));
+    }
 
     template<class S>
     std::unique_ptr<S> removeSystem() {
-        auto const id = S::staticId();
-        if constexpr (S::numDependencies() > 0) {
-            auto const found = std::find_if(std::begin(depdendent_systems_), std::end(depdendent_systems_), 
-                [id](auto const& sys) { return sys.system->id() == id; });
-            NOVA_ASSERT(found != std::end(depdendent_systems_));
-            auto ptr = found->system.release();
-            depdendent_systems_.erase(found);
-            return std::unique_ptr<S>{static_cast<S*>(ptr)};
+        auto const found = ids_.find(S::staticId());
+        NOVA_ASSERT(found != ids_.end());
+        return std::unique_ptr<S>{static_cast<S*>(release(found->second).release())};
+    }
+
+    std::unique_ptr<ISystem> removeSystem(SystemHandle const handle) {
+        NOVA_ASSERT(contains(handle));
+        return release(handle.slot);
+    }
+
+    // the reference is invalidated when systems are added or removed.
+    template<class S>
+    S& getSystem() noexcept {
+        auto const found = ids_.find(S::staticId());
+        NOVA_ASSERT(found != ids_.end());
+        auto const& s = slots_[found->second];
+        return *static_cast<S*>(stage(s.stage).get(s.index));
+    }
+
+    bool contains(SystemHandle const handle) const noexcept {
+        return handle.slot < slots_.size() && slots_[handle.slot].generation == handle.generation;
+    }
+
+    template<class S>
+    bool contains() const noexcept {
+        return ids_.contains(S::staticId());
+    }
+
+    std::size_t numSystems() const noexcept {
+        std::size_t size = 0;
+        for (auto const& systems : stages_)
+            size += systems.size();
+        return size;
+    }
+
+    // Sets a resource systems declare with ReadRes<T> or WriteRes<T>, replacing the previous value. Systems
+    // resolve resources again on the next update, so this must not be called while the World updates.
+    template<class T, class... Args>
+    T& setResource(Args&&... args) {
+        prepared_ = nullptr;
+        return reg_.set<T>(std::forward<Args>(args)...);
+    }
+
+    // the resource, default constructed if it wasn't set yet.
+    template<class T>
+    T& resource() {
+        return reg_.ctx_or_set<T>();
+    }
+
+    // sends an event from outside the systems, it goes straight into the channel so readers see it right away.
+    template<class E>
+    void send(E event) {
+        events<E>(reg_).push(std::move(event));
+    }
+
+    // the scheduler lives in the registry context, where coroutine systems find it.
+    Scheduler& scheduler() {
+        return reg_.ctx_or_set<Scheduler>();
+    }
+
+    // runs `task` across ticks, it is resumed at the start of a tick before any system runs.
+    void spawn(Task task) {
+        scheduler().spawn(std::move(task));
+    }
+
+    JobSystem& jobs() {
+        return jobs_ != nullptr ? *jobs_ : JobSystem::shared();
+    }
+
+    // Runs `job` on a worker and calls `apply(registry, result)` with its result at the start of the first tick
+    // after it finished. With a deadline the result is applied at the latest `deadline` ticks from now,
+    // that tick waits for the job if it isn't done yet.
+    template<class F, class A>
+    void submit(F&& job, A&& apply, JobPriority const priority = JobPriority::Normal, std::uint64_t const deadline = no_deadline) {
+        auto future = jobs().submit(std::forward<F>(job), priority);
+        auto const tick = deadline == no_deadline ? no_deadline : scheduler().tick() + deadline;
+        pending_jobs_.push_back(std::make_unique<detail::applied_job<typename decltype(future)::value_type, std::decay_t<A>>>(
+            tick, std::move(future), std::forward<A>(apply)));
+    }
+
+    // Applies finished jobs, resumes the spawned tasks that are due, then runs the stages in order.
+    // Within a stage, systems that don't touch the same components with one of them writing run in parallel.
+    void update(Time const dt) {
+        auto const tick_start = std::chrono::steady_clock::now();
+        sync();
+        auto& tasks = scheduler();
+        tasks.resume();
+        // the schedule is rebuilt now and then so it follows the costs measured since.
+        if (replan_interval_ > 0 && tasks.tick() % replan_interval_ == replan_interval_ - 1)
+            scheduled_ = false;
+        if (!scheduled_)
+            reschedule();
+        // systems run in parallel must not resolve pools, so a moved registry is handed to them up front.
+        if (prepared_ != &reg_) {
+            for (auto const& systems : stages_) {
+                for (auto const& entry : systems.entries())
+                    entry.system->prepare(reg_);
+            }
+            prepared_ = &reg_;
         }
-        else {
-            auto const found = std::find_if(std::begin(independent_systems_), std::end(independent_systems_), 
-                [id](auto const& sys) { return sys->id() == id; });
-            NOVA_ASSERT(found != std::end(independent_systems_));
-            auto ptr = found->release();
-            independent_systems_.erase(found);
-            return std::unique_ptr<S>{static_cast<S*>(ptr)};
+        reg_.ctx_or_set<detail::tick_deadline>().at = tick_budget_ > std::chrono::nanoseconds{0}
+            ? tick_start + tick_budget_ : std::chrono::steady_clock::time_point::max();
+        auto const start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < num_stages; ++i)
+            runStage(i);
+        last_update_ = std::chrono::steady_clock::now() - start;
+        // events sent this tick stay readable during the next one.
+        if (auto* const channels = reg_.try_ctx<detail::event_channels>())
+            channels->swap();
+        elapsed_ += dt;
+        tasks.advance(elapsed_);
+    }
+
+    // how many ticks pass between two schedules built from the measured costs, 0 only rebuilds the schedule
+    // when systems are added or removed.
+    void replanEvery(std::uint64_t const ticks) noexcept {
+        replan_interval_ = ticks;
+    }
+
+    Time elapsed() const noexcept {
+        return elapsed_;
+    }
+
+    // sets the tick and time back to the ones of an earlier tick, for rewinding the World to it.
+    void rewindClock(std::uint64_t const tick, Time const now) noexcept {
+        scheduler().rewind(tick, now);
+        elapsed_ = now;
+    }
+
+    // Copies the World for speculative simulation, e.g. lookahead: the entities and the pools of `Components`,
+    // the tick and time, and every system, which must be copyable. The copy is a World of its own with a new id,
+    // sharing the JobSystem. Spawned tasks, jobs in flight and other context variables aren't copied, and
+    // coroutine systems start their coroutine over.
+    template<class... Components>
+    World clone() const {
+        World copy;
+        copy.jobs_ = jobs_;
+        Snapshot<Components...>::copy(reg_, copy.reg_);
+        if (auto const* const tasks = reg_.try_ctx<Scheduler>())
+            copy.reg_.set<Scheduler>(tasks->tick(), tasks->now());
+        for (std::size_t i = 0; i < num_stages; ++i)
+            copy.stages_[i] = detail::system_arena{stages_[i]};
+        copy.schedules_ = schedules_;
+        copy.scheduled_ = scheduled_;
+        copy.slots_ = slots_;
+        copy.free_slots_ = free_slots_;
+        copy.ids_ = ids_;
+        copy.next_sequence_ = next_sequence_;
+        copy.elapsed_ = elapsed_;
+        copy.replan_interval_ = replan_interval_;
+        copy.rates_ = rates_;
+        copy.tick_budget_ = tick_budget_;
+        return copy;
+    }
+
+    // How long an update may take, 0 for no limit. Past it, deferrable systems stop and resume where they left
+    // off the next tick, so a load spike slows them down instead of making the tick late. The other systems run
+    // in full whatever the budget.
+    void setTickBudget(std::chrono::nanoseconds const budget) noexcept {
+        tick_budget_ = budget;
+    }
+
+    std::chrono::nanoseconds tickBudget() const noexcept {
+        return tick_budget_;
+    }
+
+    // the deferrable systems that ran out of budget during the last update and haven't finished their pass.
+    std::size_t numDeferred() const noexcept {
+        std::size_t n = 0;
+        for (auto const& systems : stages_) {
+            for (auto const& entry : systems.entries())
+                n += entry.system != nullptr && entry.system->deferred();
         }
+        return n;
     }
 
-    std::size_t numSystems() const noexcept {
-        return independent_systems_.size() + depdendent_systems_.size();
+    // how long the stages of the last update took.
+    std::chrono::nanoseconds lastUpdateTime() const noexcept {
+        return last_update_;
+    }
+
+    // The shortest the stages of the last update could have taken with unlimited workers: the sum over the stages
+    // of their longest chain of dependent systems, weighted by how long each system takes.
+    std::chrono::nanoseconds criticalPath() const {
+        std::chrono::nanoseconds total{0};
+        for (auto const& schedule : schedules_)
+            total += schedule.criticalPath();
+        return total;
     }
-    
 };
 
 } // namespace nova
\ No newline at end of file
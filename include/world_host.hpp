@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "clock.hpp"
+#include "entity.hpp"
+#include "jobs.hpp"
+#include "task.hpp"
+#include "util.hpp"
+#include "world.hpp"
+
+namespace nova {
+
+struct WorldOptions {
+    // simulated time per tick, the world ticks once every `step` of host time.
+    Time step{16};
+    // how long a tick is expected to take. A world over budget runs after the others until it is back under.
+    std::chrono::nanoseconds budget = std::chrono::milliseconds{2};
+    // ticks a world may fall behind before the missed ones are dropped instead of caught up.
+    std::uint32_t max_lag = 5;
+};
+
+// Runs many independent Worlds, such as small matches, on one JobSystem instead of a thread each. Every round
+// the worlds that are due tick once, spread over the workers, the ones furthest behind first. A world behind by
+// several ticks catches up one tick per round so it can't starve the others.
+class WorldHost {
+    struct instance {
+        std::unique_ptr<World> world;
+        WorldOptions options;
+        Time next{0};
+        std::chrono::nanoseconds last_cost{0};
+        std::uint64_t overruns = 0;
+    };
+
+    JobSystem& jobs_;
+    std::vector<instance> instances_;
+    std::vector<instance*> due_;
+
+    instance* find(WorldId const id) noexcept {
+        auto const found = std::find_if(instances_.begin(), instances_.end(), [id](auto const& i) { return i.world->id() == id; });
+        return found == instances_.end() ? nullptr : &*found;
+    }
+
+public:
+    explicit WorldHost(JobSystem& jobs = JobSystem::shared()) noexcept : jobs_(jobs) {}
+
+    WorldHost(WorldHost const&) = delete;
+    WorldHost& operator=(WorldHost const&) = delete;
+
+    // the world first ticks in the next round, its systems run on the host's JobSystem.
+    World& add(WorldOptions const& options = {}, Time const now = Time{0}) {
+        NOVA_ASSERT(options.step > Time{0});
+        instances_.push_back({std::make_unique<World>(jobs_), options, now});
+        return *instances_.back().world;
+    }
+
+    void remove(WorldId const id) {
+        auto* const i = find(id);
+        NOVA_ASSERT(i != nullptr);
+        if (i != &instances_.back())
+            *i = std::move(instances_.back());
+        instances_.pop_back();
+    }
+
+    World* get(WorldId const id) noexcept {
+        auto* const i = find(id);
+        return i == nullptr ? nullptr : i->world.get();
+    }
+
+    std::size_t size() const noexcept {
+        return instances_.size();
+    }
+
+    // how long the last tick of the world took, and how many of its ticks went over budget.
+    std::chrono::nanoseconds lastTickCost(WorldId const id) noexcept {
+        auto const* const i = find(id);
+        NOVA_ASSERT(i != nullptr);
+        return i->last_cost;
+    }
+
+    std::uint64_t overruns(WorldId const id) noexcept {
+        auto const* const i = find(id);
+        NOVA_ASSERT(i != nullptr);
+        return i->overruns;
+    }
+
+    // Ticks every world due at `now` once and returns when they are all done.
+    void tick(Time const now) {
+        due_.clear();
+        for (auto& i : instances_) {
+            if (i.next > now)
+                continue;
+            if (now - i.next >= i.options.step * i.options.max_lag)
+                i.next = now;
+            due_.push_back(&i);
+        }
+        // workers claim the worlds in order, so the ones within budget and furthest behind start first.
+        std::sort(due_.begin(), due_.end(), [now](instance const* a, instance const* b) {
+            auto const a_over = a->last_cost > a->options.budget;
+            auto const b_over = b->last_cost > b->options.budget;
+            if (a_over != b_over)
+                return !a_over;
+            return now - a->next > now - b->next;
+        });
+
+        jobs_.parallelFor(due_.size(), [this](std::size_t const k) {
+            auto& i = *due_[k];
+            auto const start = std::chrono::steady_clock::now();
+            i.world->update(i.options.step);
+            i.last_cost = std::chrono::steady_clock::now() - start;
+            if (i.last_cost > i.options.budget)
+                ++i.overruns;
+            i.next += i.options.step;
+        });
+    }
+
+    // the earliest time a world is due.
+    Time nextDue() const noexcept {
+        auto next = Time::max();
+        for (auto const& i : instances_)
+            next = std::min(next, i.next);
+        return next;
+    }
+
+    // ticks the worlds against `clock` until `stop()` returns true.
+    template<Clock C, class Stop>
+    void run(C& clock, Stop&& stop) {
+        while (!stop()) {
+            tick(clock.now());
+            // wakes up now and then even with no world due soon, `stop` may add worlds.
+            clock.sleepUntil(std::max(clock.now(), std::min(nextDue(), clock.now() + Time{100})));
+        }
+    }
+};
+
+} // namespace nova
@@ -0,0 +1,78 @@
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#include "clock.hpp"
+#include "log.hpp"
+#include "prefab.hpp"
+#include "world.hpp"
+
+// The simulation without SDL, no window, renderer or event polling, for dedicated servers.
+//   nova_headless [--hz N] [--ticks N]
+// runs at N ticks per second (60 by default, at most 1000) until SIGINT or SIGTERM, or for N ticks.
+
+struct pos : nova::component_base { float x = 0.f; float y = 0.f; };
+struct vel : nova::component_base { float dx = 0.f; float dy = 0.f; };
+
+struct Move : nova::SystemBase<Move, nova::Read<vel>, nova::Write<pos>> {
+    void process(pos& p, vel const& v) const noexcept {
+        p.x += v.dx;
+        p.y += v.dy;
+    }
+};
+
+namespace {
+
+std::atomic<bool> stop_requested{false};
+
+extern "C" void requestStop(int) {
+    stop_requested.store(true, std::memory_order_relaxed);
+}
+
+bool parse(std::string_view const arg, std::uint64_t& out) {
+    auto const [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), out);
+    return error == std::errc{} && end == arg.data() + arg.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    nova::log::Session const logging;
+
+    std::uint64_t hz = 60;
+    std::uint64_t ticks = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg = argv[i];
+        auto* const out = arg == "--hz" ? &hz : arg == "--ticks" ? &ticks : nullptr;
+        // the simulation steps in whole milliseconds.
+        if (out == nullptr || i + 1 == argc || !parse(argv[++i], *out) || hz == 0 || hz > 1000) {
+            NOVA_LOG_ERROR("usage: {} [--hz N] [--ticks N], with 1 <= N <= 1000 for --hz", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    nova::World world;
+    nova::Prefab mover{pos{}, vel{{}, 10.f, 10.f}};
+    mover.spawn(world.registry(), 10, [](std::size_t const i, pos& p, vel&) {
+        p.x = 5.f * i;
+        p.y = 5.f * i;
+    });
+    world.emplaceSystem<Move>();
+
+    nova::SteadyClock clock;
+    auto const period = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds{1}) / hz;
+    NOVA_LOG_INFO("running headless at {} Hz", hz);
+    nova::runFixed(world, clock, period, [&world, ticks] {
+        return stop_requested.load(std::memory_order_relaxed) || (ticks > 0 && world.scheduler().tick() >= ticks);
+    });
+    NOVA_LOG_INFO("stopped after {} ticks", world.scheduler().tick());
+
+    return EXIT_SUCCESS;
+}
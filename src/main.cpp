@@ -7,6 +7,8 @@
 #include <fmt/format.h>
 #include <entt/entt.hpp>
 
+#include "log.hpp"
+
 #include <iostream>
 
 using namespace sdl2;
@@ -15,27 +17,29 @@ struct pos { float x = 0.f; float y = 0.f; };
 struct vel { float dx = 0.f; float dy = 0.f; };
 
 int main(int, char**) {
+    nova::log::Session const logging;
+
     SDL2 sdl(sdl2_init_flags::EVERYTHING);
     if (!sdl) {
-        spdlog::error("SDL2 Err: {}\n", SDL2::get_error());
+        NOVA_LOG_ERROR("SDL2 Err: {}\n", SDL2::get_error());
         return EXIT_FAILURE;
     }
 
     IMG img(img_init_flags::ALL);
     if (!img) {
-        spdlog::error("IMG Err: {}\n", IMG::get_error());
+        NOVA_LOG_ERROR("IMG Err: {}\n", IMG::get_error());
         return EXIT_FAILURE;
     }
 
     window win("Game", window::pos_centered, {800, 800}, window_flags::NONE);
     if (!win) {
-        spdlog::error("SDL2 Window Err: {}\n", SDL2::get_error());
+        NOVA_LOG_ERROR("SDL2 Window Err: {}\n", SDL2::get_error());
         return EXIT_FAILURE;
     }
 
     renderer ren(win, renderer_flags::ACCELERATED);
     if (!ren) {
-        spdlog::error("SDL2 Renderer Err: {}\n", SDL2::get_error());
+        NOVA_LOG_ERROR("SDL2 Renderer Err: {}\n", SDL2::get_error());
         return EXIT_FAILURE;
     }
 